@@ -10,9 +10,256 @@ import <concepts>;
 import <print>;
 import <functional>;
 import <algorithm>;
+import <span>;
+import <filesystem>;
+import <fstream>;
+import <cstring>;
+import <chrono>;
+import <charconv>;
+import <set>;
+import <memory>;
+import <mutex>;
+import <bit>;
+import <expected>;
+import <array>;
+import <atomic>;
+import <thread>;
+import <cstdio>;
+import <iterator>;
+import <exception>;
+import <cmath>;
+import <type_traits>;
+import <deque>;
+import <tuple>;
+import <utility>;
 
 import "vulkan_config.h";
 
+/*
+ * vulkan 
+ * vulkan_config.h ж VK_NO_PROTOTYPES,  vulkan-1.lib,  vulkan ȫָֺ,  VulkanLoader д
+ * - global:  instance,  loader 󼴿ʹ
+ * - instance:  instance ͨ vkGetInstanceProcAddr 
+ * - device:  instance ͨ loader  trampoline ,  device  vkGetDeviceProcAddr ¼Ϊеʵ
+ * õĺҪӦб, չ ( debug utils) Ȼʹõĵط
+ */
+#define VULKAN_GLOBAL_FUNCTIONS(X) \
+	X(vkCreateInstance) \
+	X(vkEnumerateInstanceExtensionProperties) \
+	X(vkEnumerateInstanceLayerProperties)
+
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+#define VULKAN_PLATFORM_INSTANCE_FUNCTIONS(X) X(vkCreateWin32SurfaceKHR)
+#else
+#define VULKAN_PLATFORM_INSTANCE_FUNCTIONS(X)
+#endif
+
+#define VULKAN_INSTANCE_FUNCTIONS(X) \
+	X(vkDestroyInstance) \
+	X(vkEnumeratePhysicalDevices) \
+	X(vkEnumerateDeviceExtensionProperties) \
+	X(vkGetPhysicalDeviceFeatures) \
+	X(vkGetPhysicalDeviceProperties) \
+	X(vkGetPhysicalDeviceMemoryProperties) \
+	X(vkGetPhysicalDeviceQueueFamilyProperties) \
+	X(vkCreateDevice) \
+	X(vkGetDeviceProcAddr) \
+	X(vkDestroySurfaceKHR) \
+	X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+	X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+	X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+	X(vkGetPhysicalDeviceSurfacePresentModesKHR) \
+	VULKAN_PLATFORM_INSTANCE_FUNCTIONS(X)
+
+#define VULKAN_DEVICE_FUNCTIONS(X) \
+	X(vkDestroyDevice) \
+	X(vkDeviceWaitIdle) \
+	X(vkGetDeviceQueue) \
+	X(vkQueueSubmit) \
+	X(vkQueueWaitIdle) \
+	X(vkAllocateMemory) \
+	X(vkFreeMemory) \
+	X(vkMapMemory) \
+	X(vkUnmapMemory) \
+	X(vkCreateBuffer) \
+	X(vkDestroyBuffer) \
+	X(vkGetBufferMemoryRequirements) \
+	X(vkBindBufferMemory) \
+	X(vkCreateImage) \
+	X(vkDestroyImage) \
+	X(vkGetImageMemoryRequirements) \
+	X(vkBindImageMemory) \
+	X(vkCreateImageView) \
+	X(vkDestroyImageView) \
+	X(vkCreateFence) \
+	X(vkDestroyFence) \
+	X(vkResetFences) \
+	X(vkWaitForFences) \
+	X(vkCreateSemaphore) \
+	X(vkDestroySemaphore) \
+	X(vkCreateQueryPool) \
+	X(vkDestroyQueryPool) \
+	X(vkGetQueryPoolResults) \
+	X(vkCreatePipelineCache) \
+	X(vkDestroyPipelineCache) \
+	X(vkGetPipelineCacheData) \
+	X(vkCreatePipelineLayout) \
+	X(vkDestroyPipelineLayout) \
+	X(vkCreateDescriptorSetLayout) \
+	X(vkDestroyDescriptorSetLayout) \
+	X(vkCreateDescriptorPool) \
+	X(vkDestroyDescriptorPool) \
+	X(vkAllocateDescriptorSets) \
+	X(vkUpdateDescriptorSets) \
+	X(vkCreateRenderPass) \
+	X(vkDestroyRenderPass) \
+	X(vkCreateFramebuffer) \
+	X(vkDestroyFramebuffer) \
+	X(vkCreateCommandPool) \
+	X(vkDestroyCommandPool) \
+	X(vkResetCommandPool) \
+	X(vkAllocateCommandBuffers) \
+	X(vkBeginCommandBuffer) \
+	X(vkEndCommandBuffer) \
+	X(vkCmdPipelineBarrier) \
+	X(vkCmdBeginRenderPass) \
+	X(vkCmdEndRenderPass) \
+	X(vkCmdExecuteCommands) \
+	X(vkCmdBindPipeline) \
+	X(vkCmdBindDescriptorSets) \
+	X(vkCmdPushConstants) \
+	X(vkCmdSetViewport) \
+	X(vkCmdSetScissor) \
+	X(vkCmdDraw) \
+	X(vkCmdDrawIndexed) \
+	X(vkCmdDrawIndirect) \
+	X(vkCmdDrawIndexedIndirect) \
+	X(vkCmdDispatch) \
+	X(vkCmdCopyBuffer) \
+	X(vkCmdCopyBufferToImage) \
+	X(vkCmdClearAttachments) \
+	X(vkCmdResetQueryPool) \
+	X(vkCmdBeginQuery) \
+	X(vkCmdEndQuery) \
+	X(vkCmdWriteTimestamp) \
+	X(vkCreateSwapchainKHR) \
+	X(vkDestroySwapchainKHR) \
+	X(vkGetSwapchainImagesKHR) \
+	X(vkAcquireNextImageKHR) \
+	X(vkQueuePresentKHR)
+
+#define VULKAN_DEFINE_FUNCTION(name) PFN_##name name = nullptr;
+PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = nullptr;
+VULKAN_GLOBAL_FUNCTIONS(VULKAN_DEFINE_FUNCTION)
+VULKAN_INSTANCE_FUNCTIONS(VULKAN_DEFINE_FUNCTION)
+VULKAN_DEVICE_FUNCTIONS(VULKAN_DEFINE_FUNCTION)
+#undef VULKAN_DEFINE_FUNCTION
+
+/*
+ * ʱ vulkan loader (windows Ϊ vulkan-1.dll, ƽ̨Ϊ libvulkan.so.1), дĺ
+ * ûаװ vulkan ʱ캯׳쳣, ǳ޷
+ * ȫֵ, ͬʱֻһ VulkanLoader, ֻ֧һ device
+ */
+class VulkanLoader
+{
+public:
+	VulkanLoader();
+	~VulkanLoader();
+
+	VulkanLoader(const VulkanLoader& other) = delete;
+	VulkanLoader(VulkanLoader&& other) noexcept = delete;
+	VulkanLoader& operator=(const VulkanLoader& other) = delete;
+	VulkanLoader& operator=(VulkanLoader&& other) noexcept = delete;
+
+	//  instance 
+	void loadInstance(VkInstance instance);
+	//  device , ֮ device ĺپ loader ķַ
+	void loadDevice(VkDevice device);
+
+private:
+#ifdef _WIN32
+	HMODULE library_;
+#else
+	void* library_;
+#endif
+
+	void unload() noexcept;
+};
+
+VulkanLoader::VulkanLoader()
+{
+#ifdef _WIN32
+	library_ = LoadLibraryW(L"vulkan-1.dll");
+	if (library_ == nullptr) {
+		throw std::runtime_error("failed to load vulkan-1.dll");
+	}
+	vkGetInstanceProcAddr = reinterpret_cast<PFN_vkGetInstanceProcAddr>(GetProcAddress(library_, "vkGetInstanceProcAddr"));
+#else
+	library_ = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+	if (library_ == nullptr) {
+		// ֻװ˿ϵͳûд汾ŵļ
+		library_ = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+	}
+	if (library_ == nullptr) {
+		throw std::runtime_error(std::format("failed to load libvulkan.so.1: {}", dlerror()));
+	}
+	vkGetInstanceProcAddr = reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(library_, "vkGetInstanceProcAddr"));
+#endif
+	if (vkGetInstanceProcAddr == nullptr) {
+		unload();
+		throw std::runtime_error("vulkan loader does not export vkGetInstanceProcAddr");
+	}
+
+#define VULKAN_LOAD_FUNCTION(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(nullptr, #name));
+	VULKAN_GLOBAL_FUNCTIONS(VULKAN_LOAD_FUNCTION)
+#undef VULKAN_LOAD_FUNCTION
+	if (vkCreateInstance == nullptr) {
+		unload();
+		throw std::runtime_error("failed to load global vulkan functions");
+	}
+}
+
+VulkanLoader::~VulkanLoader()
+{
+	unload();
+}
+
+void VulkanLoader::unload() noexcept
+{
+	// ֮ĵֱӿָ, ǵѾжصĴ
+#define VULKAN_RESET_FUNCTION(name) name = nullptr;
+	VULKAN_GLOBAL_FUNCTIONS(VULKAN_RESET_FUNCTION)
+	VULKAN_INSTANCE_FUNCTIONS(VULKAN_RESET_FUNCTION)
+	VULKAN_DEVICE_FUNCTIONS(VULKAN_RESET_FUNCTION)
+#undef VULKAN_RESET_FUNCTION
+	vkGetInstanceProcAddr = nullptr;
+#ifdef _WIN32
+	FreeLibrary(library_);
+#else
+	dlclose(library_);
+#endif
+}
+
+void VulkanLoader::loadInstance(VkInstance instance)
+{
+	// instance δõչĺΪ nullptr
+#define VULKAN_LOAD_FUNCTION(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(instance, #name));
+	VULKAN_INSTANCE_FUNCTIONS(VULKAN_LOAD_FUNCTION)
+	VULKAN_DEVICE_FUNCTIONS(VULKAN_LOAD_FUNCTION)
+#undef VULKAN_LOAD_FUNCTION
+	if (vkDestroyInstance == nullptr || vkGetDeviceProcAddr == nullptr) {
+		throw std::runtime_error("failed to load instance vulkan functions");
+	}
+}
+
+void VulkanLoader::loadDevice(VkDevice device)
+{
+	// device δõչĺ vkGetDeviceProcAddr  nullptr, ʱ instance صİ汾
+#define VULKAN_LOAD_FUNCTION(name) \
+	if (const auto pfn = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name)); pfn != nullptr) name = pfn;
+	VULKAN_DEVICE_FUNCTIONS(VULKAN_LOAD_FUNCTION)
+#undef VULKAN_LOAD_FUNCTION
+}
 
 
 template<uint32_t index, typename Callable>
@@ -51,348 +298,6234 @@ struct FuncArgT
 	using type = FuncArgT<index, decltype(&Callable::operator())>::type;
 };
 
-class VulkanApplication
+// Ԫز inlineCapacity ʱڲе vector, ʱתƵ
+// ֻ vulkan ľͽṹֱӿ
+template<typename T, size_t inlineCapacity>
+	requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+class SmallVector
 {
 public:
-	VulkanApplication(const uint32_t width, const uint32_t height, const std::string_view appName);
+	[[nodiscard]] T* data() { return onHeap_ ? heap_.data() : inline_.data(); }
+	[[nodiscard]] const T* data() const { return onHeap_ ? heap_.data() : inline_.data(); }
+	[[nodiscard]] size_t size() const { return size_; }
+	[[nodiscard]] bool empty() const { return size_ == 0; }
 
-	~VulkanApplication();
+	T* begin() { return data(); }
+	T* end() { return data() + size_; }
+	const T* begin() const { return data(); }
+	const T* end() const { return data() + size_; }
 
-	VulkanApplication(const VulkanApplication& other) = delete;
-	VulkanApplication(VulkanApplication&& other) noexcept = delete;
-	VulkanApplication& operator=(const VulkanApplication& other) = delete;
-	VulkanApplication& operator=(VulkanApplication&& other) noexcept = delete;
+	T& operator[](size_t index) { return data()[index]; }
+	const T& operator[](size_t index) const { return data()[index]; }
 
-	[[nodiscard]] GLFWwindow* pWindow() const { return pWindow_; }
+	// Ԫֵʼ,  std::vector::resize ͬ
+	void resize(size_t size)
+	{
+		if (!onHeap_ && size > inlineCapacity) {
+			heap_.assign(inline_.begin(), inline_.begin() + size_);
+			onHeap_ = true;
+		}
+		if (onHeap_) {
+			heap_.resize(size);
+		}
+		else {
+			std::fill(inline_.begin() + std::min(size_, size), inline_.begin() + size, T{});
+		}
+		size_ = size;
+	}
 
-private:
-	template<typename F, typename... Args>
-		requires std::invocable<F, Args&&..., uint32_t*, FuncArg<sizeof...(Args) + 1, F>>
-	static auto getVkResource(F func, Args&&... args)
+	void push_back(const T& value)
 	{
-		uint32_t count;
-		func(args..., &count, nullptr);
-		std::vector<std::remove_pointer_t<FuncArg<sizeof...(Args) + 1, F>>> resources{ count };
-		func(args..., &count, resources.data());
-		return resources;
+		resize(size_ + 1);
+		data()[size_ - 1] = value;
 	}
 
+	void clear() { resize(0); }
+
 private:
-/*
- * glfw window 
- */
-	GLFWwindow* pWindow_;
+	std::array<T, inlineCapacity> inline_{};
+	std::vector<T> heap_;
+	size_t size_ = 0;
+	bool onHeap_ = false;
+};
 
-	void createWindow(const uint32_t width, const uint32_t height, const std::string_view title);
-	void destroyWindow() noexcept;
+// 򵥵Ķл, ֻڱĻļ, ֽͶ
+class BinaryWriter
+{
+public:
+	template<typename T>
+		requires std::is_trivially_copyable_v<T>
+	void write(const T& value)
+	{
+		const auto bytes = reinterpret_cast<const char*>(&value);
+		data_.insert(data_.end(), bytes, bytes + sizeof(T));
+	}
 
-	// ׳glfwıеĻ
-	static void checkGlfwError();
+	void writeString(std::string_view str)
+	{
+		write(static_cast<uint32_t>(str.size()));
+		data_.insert(data_.end(), str.begin(), str.end());
+	}
+
+	//  + Ԫصԭʼֽ
+	template<std::ranges::contiguous_range Range>
+		requires std::is_trivially_copyable_v<std::ranges::range_value_t<Range>>
+	void writeArray(const Range& range)
+	{
+		write(static_cast<uint32_t>(std::ranges::size(range)));
+		const auto bytes = reinterpret_cast<const char*>(std::ranges::data(range));
+		data_.insert(data_.end(), bytes, bytes + std::ranges::size(range) * sizeof(std::ranges::range_value_t<Range>));
+	}
+
+	[[nodiscard]] const std::vector<char>& data() const { return data_; }
 
 private:
-/*
- * Ƿ֤㣬debug
- */
-#ifdef NODEBUG
-	static constexpr bool enableValiLayer = false;
-	static constexpr bool enableDebugOutput = false;
-#else
-	static constexpr bool enableValiLayer = true;
-	static constexpr bool enableDebugOutput = true;
-	static constexpr VkDebugUtilsMessageSeverityFlagBitsEXT vkMessageSeverityLevel = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
-	static constexpr VkDebugUtilsMessageTypeFlagBitsEXT vkMessageTypes = VK_DEBUG_UTILS_MESSAGE_TYPE_FLAG_BITS_MAX_ENUM_EXT;
-#endif
+	std::vector<char> data_;
+};
+
+//  BinaryWriter Ӧ, ݲʱ read  false
+class BinaryReader
+{
+public:
+	explicit BinaryReader(std::span<const char> data) : data_(data) {}
+
+	template<typename T>
+		requires std::is_trivially_copyable_v<T>
+	[[nodiscard]] bool read(T& value)
+	{
+		if (data_.size() < sizeof(T)) return false;
+		std::memcpy(&value, data_.data(), sizeof(T));
+		data_ = data_.subspan(sizeof(T));
+		return true;
+	}
+
+	[[nodiscard]] bool readString(std::string& str)
+	{
+		uint32_t size;
+		if (!read(size) || data_.size() < size) return false;
+		str.assign(data_.data(), size);
+		data_ = data_.subspan(size);
+		return true;
+	}
+
+	// Container Ҫṩ resize  data (std::vector, SmallVector)
+	template<typename Container>
+	[[nodiscard]] bool readArray(Container& container)
+	{
+		using T = std::remove_cvref_t<decltype(*container.data())>;
+		uint32_t count;
+		if (!read(count) || data_.size() / sizeof(T) < count) return false;
+		container.resize(count);
+		std::memcpy(container.data(), data_.data(), count * sizeof(T));
+		data_ = data_.subspan(count * sizeof(T));
+		return true;
+	}
+
+	[[nodiscard]] bool empty() const { return data_.empty(); }
 
 private:
+	std::span<const char> data_;
+};
+
 /*
- * instance, extension, layer
- * instance: vulkanײĶһнԴinstance洢״̬
+ * present mode ѡ, ÿֲ԰˳һ present mode, ˻ص豸ֵ֧ FIFO
+ * - LowLatency: MAILBOX -> FIFO_RELAXED -> FIFO, ˺, ʾɵͼ
+ * - Uncapped: IMMEDIATE -> MAILBOX -> FIFO_RELAXED -> FIFO, ֡ʲˢ, ˺, ڲ
+ * - Relaxed: FIFO_RELAXED -> FIFO, ˢʱʾ (˺), ͬ FIFO
+ * - PowerSaving: FIFO, ֡ˢ, 
  */
-	// ͱһָ룬deviceҲ
-	VkInstance instance_;
-	// vulkanеĻصҲһԴҪ
-	VkDebugUtilsMessengerEXT debugMessenger_;
-
-	void createInstance(const std::string_view appName);
-	void destroyInstance() noexcept;
+enum class PresentPolicy
+{
+	LowLatency,
+	Uncapped,
+	Relaxed,
+	PowerSaving,
+};
 
-	// пҪṩ instance  extension
-	// glfw Ҫչ vulkan 봰ڶԽ
-	// VK_EXT_debug_utils չչdebug
-	static std::vector<const char*> getInstanceRequiredExtensions();
+std::optional<PresentPolicy> parsePresentPolicy(std::string_view name)
+{
+	if (name == "low-latency") return PresentPolicy::LowLatency;
+	if (name == "uncapped") return PresentPolicy::Uncapped;
+	if (name == "relaxed") return PresentPolicy::Relaxed;
+	if (name == "power-saving") return PresentPolicy::PowerSaving;
+	return std::nullopt;
+}
 
-	static std::vector<const char*> getRequiredLayers();
+std::string_view presentModeName(VkPresentModeKHR mode)
+{
+	switch (mode) {
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+	default: return "OTHER";
+	}
+}
 
-	// debug Ĵ
-	static VKAPI_ATTR VkBool32 VKAPI_CALL debugHandler(
-		VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-		VkDebugUtilsMessageTypeFlagsEXT messageType,
-		const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-		void* pUserData);
+// VulkanApplication ʱ
+struct ApplicationSettings
+{
+	// ޴ģʽ:  glfw ,  VK_EXT_headless_surface  surface
+	// ûʾķ ( lavapipe ʵ)
+	bool headless = false;
+	// ͬʱ GPU ִе֡, CPU ¼Ƶ N+1 ֡ʱ GPU Իִе N ֡
+	uint32_t framesInFlight = 2;
+	// job system Ĺ߳ (߳), 0 ʾԶ: Ӳ߳ - 1
+	uint32_t workerThreads = 0;
+	// ӳٺ/֮ȡ, ֧ʱڵ˳˻
+	PresentPolicy presentPolicy = PresentPolicy::PowerSaving;
+	// ͼ, ᱻ surface ֵ֧ķΧ
+	// 0 ʾԶ: minImageCount + 1, MAILBOX  3  (һʾ, һŶ, һȾ)
+	uint32_t swapChainImageCount = 0;
+	// ʹõ physical device: 豸Ӵ,  pipelineCacheUUID ʮʽ (Դ־и)
+	// Ϊʱȫѡ
+	std::string preferredDevice;
+	// ʱͳ Chrome trace JSON ʽд· (chrome://tracing  Perfetto ), Ϊʱд
+	std::string startupTracePath;
+	// ʹÿִļԱߵ capability snapshot ʱö, 豸仯ʱԶʧЧ
+	bool useCapabilitySnapshot = true;
+	// validation Ϣ messageIdNumber ۺ, ÿ id ÿ, 0 ʾ
+	uint32_t validationRateLimit = 5;
+	// ָĳЩ messageIdNumber  (ſŲϢ)
+	std::map<int32_t, uint32_t> validationRateLimitOverrides;
+	// ÿһ validation ϢĻ, 0 ʾֻ˳ʱ
+	uint32_t validationSummaryInterval = 30;
+	// ¼ÿ֡ GPU ʱ (豸֧ʱ pipeline statistics), ˳ʱƽʱ
+	bool gpuProfiling = false;
+	// 豸֧ʱʹ dynamic rendering  synchronization2 (1.3  KHR չ), رʱʹ VkRenderPass  VkFramebuffer
+	bool dynamicRendering = true;
+	//  robustBufferAccess: Խ buffer δΪ, Ե GPU , ֻŲʱ
+	bool robustBufferAccess = false;
+	// bindless ԴиԴ鳤, ᱻ豸 update-after-bind ֮
+	struct BindlessCapacity
+	{
+		uint32_t sampledImages = 65536;
+		uint32_t samplers = 1024;
+		uint32_t storageBuffers = 65536;
+	} bindlessCapacity;
+	// 첽ϴ staging λС, ϴܳ
+	VkDeviceSize uploadStagingSize = 64ull * 1024 * 1024;
+	// ÿ֡ύ transfer еϴֽ
+	VkDeviceSize uploadFrameBudget = 16ull * 1024 * 1024;
+	// ɫĶȼ, еĶвʱö,  QueueTopology
+	// ÿ֡Ⱦ present ֻʹõһ render , Ĺ߳ͨ queueTopology().submit ύ
+	struct QueueRequest
+	{
+		uint32_t count;
+		float priority;
+	};
+	QueueRequest renderQueues{ 1, 1.0f };
+	QueueRequest streamingQueues{ 1, 0.25f };
+	QueueRequest computeQueues{ 1, 0.5f };
+	// ˳ʱ׶, ÿ֡ CPU ʱ GPU ʱһ Chrome trace JSON ʽд·, Ϊʱд (Ϊʱ gpuProfiling)
+	std::string frameTracePath;
+};
 
-	//Ҫinstance ֶ debugMessenger createdestroy
-	static VkResult createDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger);
-	static void destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator);
+/*
+ * Chrome trace JSON (chrome://tracing  Perfetto ) еһ complete event
+ * ͬԴ¼ (׶, ÿ֡ CPU ʱ, GPU ʱ)  tid , ʱ䶼 StartupProfiler 
+ */
+struct TraceEvent
+{
+	std::string name;
+	std::string_view category;
+	uint32_t tid;
+	double startUs;
+	double durationUs;
+};
 
-private:
-	/*
-	 * surface 
-	 *  instance  surface
-	 */
-	VkSurfaceKHR surface_;
+// threadNames Ϊ (tid, ),  trace 鿴Ϊʾ
+void writeChromeTrace(const std::filesystem::path& path, std::span<const TraceEvent> events,
+	std::span<const std::pair<uint32_t, std::string_view>> threadNames = {})
+{
+	// ¼ֻԴе, ȻתһԱ֤ JSON Ϸ
+	auto escape = [](std::string_view str) {
+		std::string escaped;
+		for (const char c : str) {
+			if (c == '"' || c == '\\') escaped.push_back('\\');
+			escaped.push_back(c);
+		}
+		return escaped;
+	};
 
-	void createSurface();
-	void destroySurface() noexcept;
+	std::ofstream file{ path, std::ios::trunc };
+	std::println(file, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	// "M" Ϊ metadata event
+	for (const auto& [tid, name] : threadNames) {
+		std::println(file, "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}},", tid, escape(name));
+	}
+	for (const auto& [index, event] : events | std::views::enumerate) {
+		// "X" Ϊ complete event: ͬʱʼʱͳʱ
+		std::println(file, "{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}{}",
+			escape(event.name), event.category, event.tid, event.startUs, event.durationUs,
+			index + 1 == static_cast<std::ptrdiff_t>(events.size()) ? "" : ",");
+	}
+	std::println(file, "]}}");
+	if (!file) {
+		throw std::runtime_error(std::format("failed to write trace {}", path.string()));
+	}
+}
 
-private:
 /*
- * physical device 
- *  instance õ physical device
- *  surface ϵõ physical device ԣѡһʵ
- * features, queue family indices , extensions ڴ logical device
- * surface capability, format, present mode ڴ swap chain
+ * ׶εĺʱͳ
+ * zone صĶʱʱ, Ƕ, Ƕڻܱ
+ * ̵ֻ߳׶ʹ, finish ֮ټ¼ (ؽ֮ĵòü¼)
  */
-	VkPhysicalDevice physicalDevice_;
+class StartupProfiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
 
-	VkPhysicalDeviceFeatures physicalDeviceFeatures_;
-	struct QueueFamilyIndices
+	class Zone
 	{
-		uint32_t graphicsFamily;
-		uint32_t presentFamily;
-	};
-	QueueFamilyIndices queueFamilyIndices_;
+	public:
+		Zone(StartupProfiler* pProfiler, size_t index) : pProfiler_(pProfiler), index_(index) {}
+		~Zone() { if (pProfiler_ != nullptr) pProfiler_->end(index_); }
 
-	std::vector<const char*> deviceExtensions_;
+		Zone(const Zone& other) = delete;
+		Zone(Zone&& other) noexcept = delete;
+		Zone& operator=(const Zone& other) = delete;
+		Zone& operator=(Zone&& other) noexcept = delete;
 
-	VkSurfaceCapabilitiesKHR surfaceCapabilities_;
-	VkSurfaceFormatKHR surfaceFormat_;
-	VkPresentModeKHR surfacePresentMode_;
+	private:
+		StartupProfiler* pProfiler_;
+		size_t index_;
+	};
 
-	// õϸ physical device Ϣ֮ device 
-	void pickPhysicalDevice();
+	// ̬ ( getVkResource ĵô) ҲҪ¼, ʹȫʵ
+	static StartupProfiler& instance();
 
-	// пҪṩ physical device  extension
-	// VK_KHR_SWAPCHAIN_EXTENSION_NAME Ӧչֽ֧
-	static std::vector<const char*> getRequiredDeviceExtensions(VkPhysicalDevice device);
+	[[nodiscard]] Zone zone(std::string_view name);
 
-	static QueueFamilyIndices getQueueFamilyIndices(VkPhysicalDevice device, VkSurfaceKHR surface);
+	// ¼ func ĺʱ
+	template<typename F>
+	decltype(auto) measure(std::string_view name, F&& func)
+	{
+		const Zone scope = zone(name);
+		return std::forward<F>(func)();
+	}
 
-	//  device, surface Ҫ capability(extent, image count), format, present mode
-	static std::tuple<VkSurfaceCapabilitiesKHR, VkSurfaceFormatKHR, VkPresentModeKHR> getSwapChainSupport(
-		VkPhysicalDevice device, VkSurfaceKHR surface);
+	void finish() { recording_ = false; }
+
+	//  trace ¼ʱ
+	[[nodiscard]] Clock::time_point origin() const { return origin_; }
+	[[nodiscard]] std::vector<TraceEvent> traceEvents() const;
+	void writeChromeTrace(const std::filesystem::path& path) const;
+	void printSummary() const;
 
 private:
-/* logical device 
- *  logical device, õ queue
- */
+	StartupProfiler() : origin_(Clock::now()), depth_(0), recording_(true) {}
 
-	VkDevice device_;
-	struct Queues
+	struct Event
 	{
-		VkQueue graphicsQueue;
-		VkQueue presentQueue;
+		std::string name;
+		Clock::time_point start;
+		Clock::duration duration;
+		uint32_t depth;
 	};
-	Queues queues_;
-	
-	//  physical  logical device  family  queue
-	void createLogicalDevice();
-	void destroyLogicalDevice() noexcept;
-
-private:
-/*
- * swap chain 
- */
-	VkSwapchainKHR swapChain_;
-	std::vector<VkImage> swapChainImages_;
 
-	void createSwapChain();
-	void destroySwapChain() noexcept;
+	Clock::time_point origin_;
+	std::vector<Event> events_;
+	uint32_t depth_;
+	bool recording_;
 
+	void end(size_t index);
 };
 
-VkResult VulkanApplication::createDebugUtilsMessengerEXT(VkInstance instance,
-	const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator,
-	VkDebugUtilsMessengerEXT* pDebugMessenger) {
-	if (const auto func = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT")); func != nullptr) {
-		return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
-	}
-	else {
-		return VK_ERROR_EXTENSION_NOT_PRESENT;
-	}
+StartupProfiler& StartupProfiler::instance()
+{
+	static StartupProfiler profiler;
+	return profiler;
 }
 
-void VulkanApplication::destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger,
-	const VkAllocationCallbacks* pAllocator) {
-	if (const auto func = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
-		vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT")); func != nullptr) {
-		func(instance, debugMessenger, pAllocator);
-	}
+StartupProfiler::Zone StartupProfiler::zone(std::string_view name)
+{
+	if (!recording_) return Zone{ nullptr, 0 };
+	events_.push_back(Event{
+		.name = std::string(name),
+		.start = Clock::now(),
+		.duration = Clock::duration::zero(),
+		.depth = depth_,
+	});
+	depth_++;
+	return Zone{ this, events_.size() - 1 };
 }
 
-void VulkanApplication::createWindow(const uint32_t width, const uint32_t height, const std::string_view title)
+void StartupProfiler::end(size_t index)
 {
-	try {
-		if (glfwInit() != GLFW_TRUE) {
-			throw std::runtime_error("glfw init failed");
-		}
-		// ҪopenGL
-		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-		// øı䴰ڳߴ
-		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	events_[index].duration = Clock::now() - events_[index].start;
+	depth_--;
+}
 
-		pWindow_ = glfwCreateWindow(width, height, title.data(), nullptr, nullptr);
+std::vector<TraceEvent> StartupProfiler::traceEvents() const
+{
+	using Microseconds = std::chrono::duration<double, std::micro>;
+	return events_ | std::views::transform([this](const Event& event) {
+		return TraceEvent{
+			.name = event.name,
+			.category = "startup",
+			.tid = 1,
+			.startUs = Microseconds(event.start - origin_).count(),
+			.durationUs = Microseconds(event.duration).count(),
+		};
+	}) | std::ranges::to<std::vector>();
+}
 
-		checkGlfwError();
-	}
-	catch (const std::exception& e)
-	{
-		destroyWindow();
-		throw;
-	}
+void StartupProfiler::writeChromeTrace(const std::filesystem::path& path) const
+{
+	::writeChromeTrace(path, traceEvents());
 }
 
-void VulkanApplication::destroyWindow() noexcept
+void StartupProfiler::printSummary() const
 {
-	if (pWindow_ != nullptr) {
-		glfwDestroyWindow(pWindow_);
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+	// Եһ¼ĺʱΪ 100%
+	const auto total = events_.empty() ? Clock::duration::zero() : events_.front().duration;
+
+	std::println("startup timing:");
+	std::println("{:<48} {:>10} {:>7}", "stage", "ms", "%");
+	for (const auto& event : events_) {
+		const auto name = std::string(event.depth * 2, ' ') + event.name;
+		const double percent = total.count() == 0 ? 0.0 : 100.0 * event.duration / total;
+		std::println("{:<48} {:>10.3f} {:>6.1f}%", name, Milliseconds(event.duration).count(), percent);
 	}
-	glfwTerminate();
 }
 
-void VulkanApplication::checkGlfwError()
+/*
+ * нĶߵζ (Dmitry Vyukov  bounded queue)
+ * ÿλһ,  CAS ռдλ, д󷢲, ߰жϲλǷɶ
+ * ʱ tryPush ֱʧܶǵȴ, Զ
+ */
+template<typename T, size_t capacity>
+	requires (std::has_single_bit(capacity))
+class MpscRingBuffer
 {
-	std::string error;
+public:
+	MpscRingBuffer() : slots_(std::make_unique<Slot[]>(capacity)), enqueuePos_(0), dequeuePos_(0)
+	{
+		for (size_t i = 0; i < capacity; i++) {
+			slots_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// ̵߳, fill ռĲλԭع (ջϿ)
+	template<typename Fill>
+	bool tryPush(Fill&& fill)
+	{
+		size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+		Slot* pSlot;
+		while (true) {
+			pSlot = &slots_[pos & (capacity - 1)];
+			const size_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+			if (diff == 0) {
+				if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (diff < 0) {
+				// ߻ûȡһȦ֮ǰ, 
+				return false;
+			}
+			else {
+				pos = enqueuePos_.load(std::memory_order_relaxed);
+			}
+		}
+		std::forward<Fill>(fill)(pSlot->value);
+		pSlot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// ֻΨһ̵߳
+	template<typename Consume>
+	bool tryPop(Consume&& consume)
+	{
+		Slot& slot = slots_[dequeuePos_ & (capacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) return false;
+		std::forward<Consume>(consume)(slot.value);
+		slot.sequence.store(dequeuePos_ + capacity, std::memory_order_release);
+		dequeuePos_++;
+		return true;
+	}
+
+private:
+	// Զռ, ֮, ֮α
+	struct alignas(64) Slot
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Slot[]> slots_;
+	alignas(64) std::atomic<size_t> enqueuePos_;
+	alignas(64) size_t dequeuePos_;
+};
+
+/*
+ * validation layer Ϣ첽
+ * debugHandler ߳ϱ, ֱ println ڿ̨ϴл, Ϣ vulkan 
+ * صֻϢ, ɺ̸̨߳ʽд
+ * - ʱϢ, ̨̻߳б涪
+ * - Ϣضϱ
+ * - ʱдʣϢٽ߳
+ * ̨߳ͬʱ messageIdNumber ۺ (ۺ״ֻ̬ں̷̨߳, Ҫͬ):
+ * - ÿ id ÿ rateLimit , ֻ, ÿ֡ظľ治ˢ
+ * - ÿ summaryInterval ʱڳֹ id Ļ, ˳ʱȫ id Ļ
+ */
+class DebugMessageLog
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Config
+	{
+		// ÿ id ÿ, 0 ʾ
+		uint32_t rateLimit;
+		// ָĳЩ id ,  rateLimit
+		std::map<int32_t, uint32_t> rateLimitOverrides;
+		// ڻܵļ, 0 ʾֻ˳ʱ
+		std::chrono::seconds summaryInterval;
+	};
+
+	struct Message
+	{
+		VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+		VkDebugUtilsMessageTypeFlagsEXT type;
+		int32_t messageIdNumber;
+		Clock::time_point time;
+		char messageIdName[128];
+		uint32_t length;
+		bool truncated;
+		char text[2048];
+	};
+
+	struct Stats
+	{
+		uint64_t pushed;
+		uint64_t dropped;
+		uint64_t truncated;
+	};
+
+	explicit DebugMessageLog(Config config);
+	~DebugMessageLog();
+
+	DebugMessageLog(const DebugMessageLog& other) = delete;
+	DebugMessageLog(DebugMessageLog&& other) noexcept = delete;
+	DebugMessageLog& operator=(const DebugMessageLog& other) = delete;
+	DebugMessageLog& operator=(DebugMessageLog&& other) noexcept = delete;
+
+	// ̵߳, 
+	void push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+		const VkDebugUtilsMessengerCallbackDataEXT& callbackData) noexcept;
+
+	[[nodiscard]] Stats stats() const;
+
+	static std::string_view severityName(VkDebugUtilsMessageSeverityFlagBitsEXT severity);
+	static std::string_view typeName(VkDebugUtilsMessageTypeFlagsEXT type);
+
+private:
+	// ͬһ messageIdNumber ͳ
+	struct Aggregate
+	{
+		std::string name;
+		VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+		uint64_t count;
+		// û
+		uint64_t suppressed;
+		// ϴλ֮, ڻֵֻΪ 0  id
+		uint64_t countSinceSummary;
+		Clock::time_point first;
+		Clock::time_point last;
+		//  1 Ĺ̶ڼ
+		Clock::time_point windowStart;
+		uint32_t windowCount;
+	};
+
+	const Config config_;
+	const Clock::time_point origin_;
+	std::map<int32_t, Aggregate> aggregates_;
+	Clock::time_point lastSummary_;
+
+	MpscRingBuffer<Message, 256> ring_;
+	std::atomic<uint64_t> pushed_;
+	std::atomic<uint64_t> dropped_;
+	std::atomic<uint64_t> truncated_;
+	// , ֤߳Աɺ, Ա֮ǰ
+	std::jthread writer_;
+
+	void writerLoop(std::stop_token stopToken);
+	// ȡеǰеϢд, ǷȡϢ
+	bool drain(std::string& buffer, uint64_t& reportedDropped);
+	// ¾ۺͳ, ϢǷҪ
+	bool aggregate(const Message& message);
+	// final Ϊ false ʱֻϴλֹ֮ id
+	void writeSummary(std::string& buffer, bool final);
+};
+
+DebugMessageLog::DebugMessageLog(Config config)
+	: config_(std::move(config)), origin_(Clock::now()), lastSummary_(origin_),
+	pushed_(0), dropped_(0), truncated_(0),
+	writer_([this](std::stop_token stopToken) { writerLoop(stopToken); })
+{
+}
+
+DebugMessageLog::~DebugMessageLog()
+{
+	writer_.request_stop();
+	writer_.join();
+}
+
+void DebugMessageLog::push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+	const VkDebugUtilsMessengerCallbackDataEXT& callbackData) noexcept
+{
+	bool truncated = false;
+	const bool pushed = ring_.tryPush([&](Message& message) {
+		const std::string_view text = callbackData.pMessage != nullptr ? callbackData.pMessage : "";
+		message.severity = severity;
+		message.type = type;
+		message.messageIdNumber = callbackData.messageIdNumber;
+		message.time = Clock::now();
+		const std::string_view idName = callbackData.pMessageIdName != nullptr ? callbackData.pMessageIdName : "";
+		const auto idNameLength = std::min(idName.size(), sizeof(message.messageIdName) - 1);
+		std::memcpy(message.messageIdName, idName.data(), idNameLength);
+		message.messageIdName[idNameLength] = '\0';
+		message.length = static_cast<uint32_t>(std::min(text.size(), sizeof(message.text)));
+		message.truncated = truncated = message.length < text.size();
+		std::memcpy(message.text, text.data(), message.length);
+	});
+	if (!pushed) {
+		dropped_.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	pushed_.fetch_add(1, std::memory_order_relaxed);
+	if (truncated) truncated_.fetch_add(1, std::memory_order_relaxed);
+}
+
+DebugMessageLog::Stats DebugMessageLog::stats() const
+{
+	return Stats{
+		.pushed = pushed_.load(std::memory_order_relaxed),
+		.dropped = dropped_.load(std::memory_order_relaxed),
+		.truncated = truncated_.load(std::memory_order_relaxed),
+	};
+}
+
+void DebugMessageLog::writerLoop(std::stop_token stopToken)
+{
+	std::string buffer;
+	uint64_t reportedDropped = 0;
+	while (!stopToken.stop_requested()) {
+		// ûϢʱ, ߲ҪκλѲ
+		if (!drain(buffer, reportedDropped)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		if (config_.summaryInterval.count() != 0 && Clock::now() - lastSummary_ >= config_.summaryInterval) {
+			buffer.clear();
+			writeSummary(buffer, false);
+			std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+			std::fflush(stdout);
+		}
+	}
+	// ֹͣǰдʣϢջ
+	while (drain(buffer, reportedDropped)) {}
+	buffer.clear();
+	writeSummary(buffer, true);
+	std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+	std::fflush(stdout);
+}
+
+bool DebugMessageLog::drain(std::string& buffer, uint64_t& reportedDropped)
+{
+	buffer.clear();
+	bool any = false;
+	while (ring_.tryPop([this, &buffer](const Message& message) {
+		if (!aggregate(message)) return;
+		std::format_to(std::back_inserter(buffer), "validation layer: ({},{}) {}{}\n",
+			severityName(message.severity),
+			typeName(message.type),
+			std::string_view(message.text, message.length),
+			message.truncated ? " ...(truncated)" : "");
+	})) {
+		any = true;
+	}
+
+	const auto dropped = dropped_.load(std::memory_order_relaxed);
+	if (dropped != reportedDropped) {
+		std::format_to(std::back_inserter(buffer), "validation layer: {} messages dropped (queue full)\n", dropped - reportedDropped);
+		reportedDropped = dropped;
+	}
+
+	if (!buffer.empty()) {
+		std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+		std::fflush(stdout);
+	}
+	return any;
+}
+
+bool DebugMessageLog::aggregate(const Message& message)
+{
+	auto [iter, inserted] = aggregates_.try_emplace(message.messageIdNumber);
+	auto& entry = iter->second;
+	if (inserted) {
+		entry.name = message.messageIdName;
+		entry.severity = message.severity;
+		entry.first = message.time;
+		entry.windowStart = message.time;
+	}
+	entry.count++;
+	entry.countSinceSummary++;
+	entry.last = message.time;
+	// ͬһ id һ㲻, Էһ¼ص
+	entry.severity = std::max(entry.severity, message.severity);
+
+	if (message.time - entry.windowStart >= std::chrono::seconds(1)) {
+		entry.windowStart = message.time;
+		entry.windowCount = 0;
+	}
+	const auto pOverride = config_.rateLimitOverrides.find(message.messageIdNumber);
+	const auto limit = pOverride != config_.rateLimitOverrides.end() ? pOverride->second : config_.rateLimit;
+	if (limit != 0 && entry.windowCount >= limit) {
+		entry.suppressed++;
+		return false;
+	}
+	entry.windowCount++;
+	return true;
+}
+
+void DebugMessageLog::writeSummary(std::string& buffer, bool final)
+{
+	using Seconds = std::chrono::duration<double>;
+	lastSummary_ = Clock::now();
+
+	std::vector<std::pair<int32_t, Aggregate*>> rows;
+	for (auto& [id, entry] : aggregates_) {
+		if (final || entry.countSinceSummary != 0) {
+			rows.emplace_back(id, &entry);
+		}
+	}
+	if (rows.empty()) return;
+	// ִǰ
+	std::ranges::sort(rows, std::ranges::greater{}, [final](const auto& row) {
+		return final ? row.second->count : row.second->countSinceSummary;
+	});
+
+	std::format_to(std::back_inserter(buffer), "validation summary ({}, {} ids):\n",
+		final ? "total" : std::format("last {}s", config_.summaryInterval.count()), rows.size());
+	std::format_to(std::back_inserter(buffer), "{:>10} {:<8} {:>10} {:>10} {:>10} {:>10}  {}\n",
+		"id", "severity", "count", "suppressed", "first(s)", "last(s)", "name");
+	for (const auto [id, pAggregate] : rows) {
+		std::format_to(std::back_inserter(buffer), "{:>#10x} {:<8} {:>10} {:>10} {:>10.3f} {:>10.3f}  {}\n",
+			static_cast<uint32_t>(id), severityName(pAggregate->severity),
+			final ? pAggregate->count : pAggregate->countSinceSummary, pAggregate->suppressed,
+			Seconds(pAggregate->first - origin_).count(), Seconds(pAggregate->last - origin_).count(),
+			pAggregate->name);
+		pAggregate->countSinceSummary = 0;
+	}
+}
+
+std::string_view DebugMessageLog::severityName(VkDebugUtilsMessageSeverityFlagBitsEXT severity)
+{
+	switch (severity) {
+	case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT: return "VERBOSE";
+	case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT: return "INFO";
+	case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT: return "WARNING";
+	case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT: return "ERROR";
+	default: return "OTHER";
+	}
+}
+
+std::string_view DebugMessageLog::typeName(VkDebugUtilsMessageTypeFlagsEXT type)
+{
+	switch (type) {
+	case VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT: return "GENERAL";
+	case VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT: return "VALIDATION";
+	case VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT: return "PERFORMANCE";
+	case VK_DEBUG_UTILS_MESSAGE_TYPE_DEVICE_ADDRESS_BINDING_BIT_EXT: return "DEVICE_ADDRESS_BINDING";
+	default: return "OTHER";
+	}
+}
+
+/*
+ * ֡ͳ
+ * ¼ÿ֡ acquire, submit, present  CPU ʱ, Լͼʵʾʱ ( VK_GOOGLE_display_timing ʱ)
+ * ֡ʾƽֵ,  (׼), ֵ, Լ vblank 
+ * -  display timing ʱ actualPresentTime, ˻Ϊ vkQueuePresentKHR ʱ CPU ʱ
+ *   (FIFO  present/acquire ᱻ vblank , CPU ʱʾ)
+ * - ˢδ֪ (޴ģʽ, ߲ vblank  present mode) ʱͳƴ vblank
+ * - ؽ, ֡ discontinuity, һͳ
+ */
+class FramePacer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct FrameTiming
+	{
+		uint32_t presentId;
+		Clock::time_point acquireBegin;
+		Clock::time_point acquireEnd;
+		Clock::time_point submit;
+		Clock::time_point present;
+		// ʵʾʱ (), Ϊ 0 ʾû (û) 
+		uint64_t actualPresentTime;
+	};
+
+	struct Stats
+	{
+		bool displayTiming;
+		// 0 ʾˢδ֪
+		double refreshPeriodMs;
+		uint64_t intervals;
+		double meanIntervalMs;
+		double jitterMs;
+		double maxIntervalMs;
+		uint64_t missedVblanks;
+		// vkAcquireNextImageKHR ƽʱ
+		double meanAcquireMs;
+	};
+
+	explicit FramePacer(size_t historySize = 512) : history_(historySize), frames_(0) {}
+
+	// refreshPeriod Ϊ 0 ʾδ֪
+	void configure(bool displayTiming, std::chrono::nanoseconds refreshPeriod);
+
+	void beginAcquire() { current_ = FrameTiming{ .acquireBegin = Clock::now() }; }
+	void endAcquire() { current_.acquireEnd = Clock::now(); }
+	void submitted() { current_.submit = Clock::now(); }
+	//  vkQueuePresentKHR ֮
+	void presented(uint32_t presentId);
+	// ʾʱ, ֮֡ŵ
+	void displayed(uint32_t presentId, uint64_t actualPresentTime);
+	void discontinuity() { hasLastInterval_ = false; }
+
+	[[nodiscard]] Stats stats() const;
+	// ֡, ʱ˳
+	[[nodiscard]] std::vector<FrameTiming> history() const;
+
+private:
+	std::vector<FrameTiming> history_;
+	uint64_t frames_;
+	FrameTiming current_{};
+
+	bool displayTiming_ = false;
+	std::chrono::nanoseconds refreshPeriod_{ 0 };
+
+	// һյ: CPU ģʽΪ present ʱ, display timing ģʽΪ actualPresentTime
+	bool hasLastInterval_ = false;
+	uint32_t lastPresentId_ = 0;
+	uint64_t lastTime_ = 0;
+
+	// ľֵͷ (Welford 㷨), Ҫ
+	uint64_t intervals_ = 0;
+	double meanInterval_ = 0.0;
+	double m2Interval_ = 0.0;
+	double maxInterval_ = 0.0;
+	uint64_t missedVblanks_ = 0;
+	double acquireSum_ = 0.0;
+
+	void addInterval(uint32_t presentId, uint64_t timeNs);
+};
+
+void FramePacer::configure(bool displayTiming, std::chrono::nanoseconds refreshPeriod)
+{
+	displayTiming_ = displayTiming;
+	refreshPeriod_ = refreshPeriod;
+	hasLastInterval_ = false;
+}
+
+void FramePacer::presented(uint32_t presentId)
+{
+	current_.presentId = presentId;
+	current_.present = Clock::now();
+	history_[frames_ % history_.size()] = current_;
+	frames_++;
+	acquireSum_ += std::chrono::duration<double, std::milli>(current_.acquireEnd - current_.acquireBegin).count();
+
+	if (!displayTiming_) {
+		addInterval(presentId, std::chrono::duration_cast<std::chrono::nanoseconds>(current_.present.time_since_epoch()).count());
+	}
+}
+
+void FramePacer::displayed(uint32_t presentId, uint64_t actualPresentTime)
+{
+	// presentId  frameCount_ ض϶, ֻȻ history_ ʱ¼¼
+	const uint64_t count = std::min<uint64_t>(frames_, history_.size());
+	for (uint64_t i = 0; i < count; i++) {
+		auto& timing = history_[(frames_ - 1 - i) % history_.size()];
+		if (timing.presentId == presentId) {
+			timing.actualPresentTime = actualPresentTime;
+			break;
+		}
+	}
+	if (displayTiming_) {
+		addInterval(presentId, actualPresentTime);
+	}
+}
+
+void FramePacer::addInterval(uint32_t presentId, uint64_t timeNs)
+{
+	// ֻͳ֮֡ļ, мȱʧ֡ (ûз) üʧ
+	const bool adjacent = hasLastInterval_ && presentId == lastPresentId_ + 1 && timeNs > lastTime_;
+	const double interval = adjacent ? static_cast<double>(timeNs - lastTime_) / 1e6 : 0.0;
+	hasLastInterval_ = true;
+	lastPresentId_ = presentId;
+	lastTime_ = timeNs;
+	if (!adjacent) return;
+
+	intervals_++;
+	const double delta = interval - meanInterval_;
+	meanInterval_ += delta / static_cast<double>(intervals_);
+	m2Interval_ += delta * (interval - meanInterval_);
+	maxInterval_ = std::max(maxInterval_, interval);
+
+	//  n ˢ, ˵м n - 1  vblank ûͼ
+	if (refreshPeriod_.count() != 0) {
+		const double periods = std::round(interval * 1e6 / static_cast<double>(refreshPeriod_.count()));
+		if (periods > 1.0) {
+			missedVblanks_ += static_cast<uint64_t>(periods) - 1;
+		}
+	}
+}
+
+FramePacer::Stats FramePacer::stats() const
+{
+	return Stats{
+		.displayTiming = displayTiming_,
+		.refreshPeriodMs = static_cast<double>(refreshPeriod_.count()) / 1e6,
+		.intervals = intervals_,
+		.meanIntervalMs = meanInterval_,
+		.jitterMs = intervals_ > 1 ? std::sqrt(m2Interval_ / static_cast<double>(intervals_ - 1)) : 0.0,
+		.maxIntervalMs = maxInterval_,
+		.missedVblanks = missedVblanks_,
+		.meanAcquireMs = frames_ != 0 ? acquireSum_ / static_cast<double>(frames_) : 0.0,
+	};
+}
+
+std::vector<FramePacer::FrameTiming> FramePacer::history() const
+{
+	const uint64_t count = std::min<uint64_t>(frames_, history_.size());
+	std::vector<FrameTiming> timings;
+	timings.reserve(count);
+	for (uint64_t i = frames_ - count; i < frames_; i++) {
+		timings.push_back(history_[i % history_.size()]);
+	}
+	return timings;
+}
+
+/*
+ * GPU ʱ profiler
+ * ÿ in flight ֡ͬһ query pool ӵһ timestamp query, ¼ʱ scope ֵ (Ƕ)
+ * - ֡ fence ȴ֮ ( framesInFlight ֮֡) Ŷؽ, ʱд, زҪȴ GPU
+ *   ʱ availability, ûдõֱӶ, 
+ * - tick  timestampPeriod Ϊ,  timestampValidBits Чĸλ
+ * - ʱһ GPU/CPU ʱУ׼,  GPU ʱ任㵽 CPU ʱ,  CPU  trace ¼һ鿴
+ * 岻֧ʱ (timestampValidBits Ϊ 0) ʱвǿղ
+ * 豸֧ pipelineStatisticsQuery ʱ, pass ʱ֮⻹¼ pipeline statistics (/ƬԪ/ɫ, üͼԪ),
+ * طʽʱͬ, ÿ֡Ϊһݱ
+ * - pipeline statistics query Ƕ, pass ֻڶʹ, Ƕ׵ pass ֻ¼ʱ
+ */
+class GpuProfiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	class Scope
+	{
+	public:
+		Scope(GpuProfiler* pProfiler, VkCommandBuffer commandBuffer, uint32_t index)
+			: pProfiler_(pProfiler), commandBuffer_(commandBuffer), index_(index) {}
+		~Scope() { if (pProfiler_ != nullptr) pProfiler_->end(commandBuffer_, index_); }
+
+		Scope(const Scope& other) = delete;
+		Scope(Scope&& other) noexcept = delete;
+		Scope& operator=(const Scope& other) = delete;
+		Scope& operator=(Scope&& other) noexcept = delete;
+
+	private:
+		GpuProfiler* pProfiler_;
+		VkCommandBuffer commandBuffer_;
+		uint32_t index_;
+	};
+
+	// pass = ʱ scope + pipeline statistics query
+	class Pass
+	{
+	public:
+		Pass(GpuProfiler* pProfiler, VkCommandBuffer commandBuffer, std::string_view name)
+			: scope_(pProfiler->scope(commandBuffer, name)), pProfiler_(pProfiler), commandBuffer_(commandBuffer),
+			statisticsIndex_(pProfiler->beginStatistics(commandBuffer, name)) {}
+		// Ƚ statistics query, ֮ scope_ ʱдʱ
+		~Pass() { if (statisticsIndex_.has_value()) pProfiler_->endStatistics(commandBuffer_, *statisticsIndex_); }
+
+		Pass(const Pass& other) = delete;
+		Pass(Pass&& other) noexcept = delete;
+		Pass& operator=(const Pass& other) = delete;
+		Pass& operator=(Pass&& other) noexcept = delete;
+
+	private:
+		Scope scope_;
+		GpuProfiler* pProfiler_;
+		VkCommandBuffer commandBuffer_;
+		std::optional<uint32_t> statisticsIndex_;
+	};
+
+	// ˳ statisticFlags λ˳ͬ
+	struct PipelineStatistics
+	{
+		uint64_t vertexShaderInvocations;
+		uint64_t clippingPrimitives;
+		uint64_t fragmentShaderInvocations;
+		uint64_t computeShaderInvocations;
+
+		PipelineStatistics& operator+=(const PipelineStatistics& other)
+		{
+			vertexShaderInvocations += other.vertexShaderInvocations;
+			clippingPrimitives += other.clippingPrimitives;
+			fragmentShaderInvocations += other.fragmentShaderInvocations;
+			computeShaderInvocations += other.computeShaderInvocations;
+			return *this;
+		}
+	};
+	static constexpr VkQueryPipelineStatisticFlags statisticFlags =
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+	// һ֡ڸ pass  pipeline statistics
+	struct FrameStatistics
+	{
+		uint64_t frameNumber;
+		std::vector<std::pair<std::string_view, PipelineStatistics>> passes;
+		PipelineStatistics total;
+	};
+
+	//  pass ֡ϵ pipeline statistics ֮, ˳ʱĻ
+	struct PassStatisticsTotal
+	{
+		std::string_view name;
+		uint64_t count;
+		PipelineStatistics sum;
+	};
+
+	//  scope ͳ, ˳ʱĻ
+	struct ScopeStats
+	{
+		std::string_view name;
+		uint64_t count;
+		double totalMs;
+		double maxMs;
+	};
+
+	GpuProfiler(VkDevice device, const VkPhysicalDeviceProperties& properties, uint32_t timestampValidBits,
+		bool pipelineStatistics, uint32_t framesInFlight, uint32_t maxScopesPerFrame = 64, uint32_t maxPassesPerFrame = 16);
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler& other) = delete;
+	GpuProfiler(GpuProfiler&& other) noexcept = delete;
+	GpuProfiler& operator=(const GpuProfiler& other) = delete;
+	GpuProfiler& operator=(GpuProfiler&& other) noexcept = delete;
+
+	[[nodiscard]] bool enabled() const { return queryPool_ != VK_NULL_HANDLE; }
+	[[nodiscard]] bool pipelineStatisticsEnabled() const { return statisticsPool_ != VK_NULL_HANDLE; }
+
+	//  queue дһʱȴ, ´ʱ CPU ʱ, ֻڴһ
+	void calibrate(VkQueue queue, uint32_t queueFamilyIndex);
+
+	// ظ֡λһεĽ, ڸ֡ fence ȴ֮
+	void collect(uint32_t frameIndex);
+	// 忪ͷ, ø֡λ query, frameNumber ڱǸ֡ı
+	void beginFrame(uint32_t frameIndex, VkCommandBuffer commandBuffer, uint64_t frameNumber);
+
+	// name Ҫ profiler ø (һΪ)
+	[[nodiscard]] Scope scope(VkCommandBuffer commandBuffer, std::string_view name);
+	[[nodiscard]] Pass pass(VkCommandBuffer commandBuffer, std::string_view name) { return Pass{ this, commandBuffer, name }; }
+
+	// һζص֡ pipeline statistics
+	[[nodiscard]] const FrameStatistics& lastFrameStatistics() const { return lastFrameStatistics_; }
+	[[nodiscard]] std::vector<PassStatisticsTotal> passStatistics() const;
+
+	// ʱ origin Ϊ
+	[[nodiscard]] std::vector<TraceEvent> traceEvents(Clock::time_point origin) const;
+	[[nodiscard]] std::vector<ScopeStats> scopeStats() const;
+	// Ϊ query ߽ö scope 
+	[[nodiscard]] uint64_t droppedScopes() const { return droppedScopes_; }
+
+private:
+	struct PendingScope
+	{
+		std::string_view name;
+		uint32_t depth;
+		// ֡λڵ query ±, ʱΪ beginQuery + 1
+		uint32_t beginQuery;
+	};
+
+	struct FrameSlot
+	{
+		std::vector<PendingScope> scopes;
+		// ֡λڵ statistics query ±꼴Ϊ passes е±
+		std::vector<std::string_view> passes;
+		uint32_t depth;
+		bool passActive;
+		bool recorded;
+		uint64_t frameNumber;
+	};
+
+	struct Event
+	{
+		std::string_view name;
+		uint32_t depth;
+		// CPU ʱϵʱ
+		Clock::time_point start;
+		std::chrono::nanoseconds duration;
+	};
+
+	VkDevice device_;
+	VkQueryPool queryPool_;
+	VkQueryPool statisticsPool_;
+	uint32_t passesPerFrame_;
+	double timestampPeriod_;
+	uint64_t timestampMask_;
+	uint32_t queriesPerFrame_;
+	std::vector<FrameSlot> frames_;
+	uint32_t currentFrame_;
+
+	// У׼: ͬһʱ̵ GPU tick  CPU ʱ
+	uint64_t calibrationTicks_;
+	Clock::time_point calibrationTime_;
+
+	// ¼, д trace , ʱ
+	static constexpr size_t maxEvents = 1 << 16;
+	std::vector<Event> events_;
+	size_t eventsBegin_;
+	std::map<std::string_view, ScopeStats> stats_;
+	uint64_t droppedScopes_;
+	// õĶػ: ÿ query һ (ֵ, availability)
+	std::vector<uint64_t> results_;
+
+	FrameStatistics lastFrameStatistics_;
+	std::map<std::string_view, PassStatisticsTotal> passStatistics_;
+	// õĶػ: ÿ query Ϊ 4  + availability
+	std::vector<uint64_t> statisticsResults_;
+
+	void end(VkCommandBuffer commandBuffer, uint32_t index);
+	// Ѿл pass  query ʱؿ
+	std::optional<uint32_t> beginStatistics(VkCommandBuffer commandBuffer, std::string_view name);
+	void endStatistics(VkCommandBuffer commandBuffer, uint32_t index);
+	void collectStatistics(uint32_t frameIndex);
+	Clock::time_point toCpuTime(uint64_t ticks) const;
+};
+
+GpuProfiler::GpuProfiler(VkDevice device, const VkPhysicalDeviceProperties& properties, uint32_t timestampValidBits,
+	bool pipelineStatistics, uint32_t framesInFlight, uint32_t maxScopesPerFrame, uint32_t maxPassesPerFrame)
+	: device_(device), queryPool_(VK_NULL_HANDLE), statisticsPool_(VK_NULL_HANDLE), passesPerFrame_(maxPassesPerFrame),
+	timestampPeriod_(properties.limits.timestampPeriod),
+	timestampMask_(timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1),
+	queriesPerFrame_(maxScopesPerFrame * 2), frames_(framesInFlight), currentFrame_(0),
+	calibrationTicks_(0), calibrationTime_(Clock::now()), eventsBegin_(0), droppedScopes_(0), lastFrameStatistics_{}
+{
+	if (pipelineStatistics) {
+		const VkQueryPoolCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+			.queryCount = passesPerFrame_ * framesInFlight,
+			.pipelineStatistics = statisticFlags,
+		};
+		if (vkCreateQueryPool(device_, &createInfo, nullptr, &statisticsPool_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline statistics query pool");
+		}
+		statisticsResults_.resize(passesPerFrame_ * (sizeof(PipelineStatistics) / sizeof(uint64_t) + 1));
+	}
+
+	if (timestampValidBits == 0) {
+		return;
+	}
+	const VkQueryPoolCreateInfo createInfo{
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = queriesPerFrame_ * framesInFlight,
+	};
+	if (vkCreateQueryPool(device_, &createInfo, nullptr, &queryPool_) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create timestamp query pool");
+	}
+	results_.resize(queriesPerFrame_ * 2);
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	vkDestroyQueryPool(device_, statisticsPool_, nullptr);
+	vkDestroyQueryPool(device_, queryPool_, nullptr);
+}
+
+void GpuProfiler::calibrate(VkQueue queue, uint32_t queueFamilyIndex)
+{
+	if (!enabled()) return;
+	/*
+	 * õһ֡λĵһ query дһʱ, CPU ʱȡύǰ͵ȴе
+	 * һύʱ, ڲ鿴 trace 㹻
+	 */
+	const VkCommandPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = queueFamilyIndex,
+	};
+	VkCommandPool commandPool = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;
+	const VkFenceCreateInfo fenceCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+	};
+	try {
+		if (vkCreateCommandPool(device_, &poolCreateInfo, nullptr, &commandPool) != VK_SUCCESS ||
+			vkCreateFence(device_, &fenceCreateInfo, nullptr, &fence) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create timestamp calibration objects");
+		}
+		const VkCommandBufferAllocateInfo allocateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = commandPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(device_, &allocateInfo, &commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate timestamp calibration command buffer");
+		}
+		const VkCommandBufferBeginInfo beginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		};
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		vkCmdResetQueryPool(commandBuffer, queryPool_, 0, 1);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool_, 0);
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record timestamp calibration command buffer");
+		}
+		const VkSubmitInfo submitInfo{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &commandBuffer,
+		};
+		const auto before = Clock::now();
+		if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS ||
+			vkWaitForFences(device_, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit timestamp calibration");
+		}
+		const auto after = Clock::now();
+		uint64_t ticks = 0;
+		if (vkGetQueryPoolResults(device_, queryPool_, 0, 1, sizeof(ticks), &ticks, sizeof(ticks), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+			throw std::runtime_error("failed to read timestamp calibration");
+		}
+		calibrationTicks_ = ticks & timestampMask_;
+		calibrationTime_ = before + (after - before) / 2;
+	}
+	catch (...) {
+		vkDestroyFence(device_, fence, nullptr);
+		vkDestroyCommandPool(device_, commandPool, nullptr);
+		throw;
+	}
+	vkDestroyFence(device_, fence, nullptr);
+	vkDestroyCommandPool(device_, commandPool, nullptr);
+}
+
+void GpuProfiler::collect(uint32_t frameIndex)
+{
+	auto& frame = frames_[frameIndex];
+	if (!frame.recorded) return;
+	frame.recorded = false;
+	collectStatistics(frameIndex);
+	if (!enabled() || frame.scopes.empty()) return;
+
+	// ֻһõ query Ϊֹ
+	const uint32_t queryCount = frame.scopes.back().beginQuery + 2;
+	vkGetQueryPoolResults(device_, queryPool_, frameIndex * queriesPerFrame_, queryCount,
+		results_.size() * sizeof(uint64_t), results_.data(), 2 * sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	for (const auto& scope : frame.scopes) {
+		const uint64_t* pBegin = &results_[scope.beginQuery * 2];
+		const uint64_t* pEnd = &results_[(scope.beginQuery + 1) * 2];
+		// ڶֵΪ availability
+		if (pBegin[1] == 0 || pEnd[1] == 0) {
+			droppedScopes_++;
+			continue;
+		}
+		const auto begin = toCpuTime(pBegin[0] & timestampMask_);
+		const auto end = toCpuTime(pEnd[0] & timestampMask_);
+		const auto duration = std::max(std::chrono::nanoseconds(0), std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin));
+
+		const Event event{ .name = scope.name, .depth = scope.depth, .start = begin, .duration = duration };
+		if (events_.size() < maxEvents) {
+			events_.push_back(event);
+		}
+		else {
+			events_[eventsBegin_] = event;
+			eventsBegin_ = (eventsBegin_ + 1) % maxEvents;
+		}
+
+		const double ms = std::chrono::duration<double, std::milli>(duration).count();
+		auto& stats = stats_.try_emplace(scope.name, ScopeStats{ .name = scope.name }).first->second;
+		stats.count++;
+		stats.totalMs += ms;
+		stats.maxMs = std::max(stats.maxMs, ms);
+	}
+}
+
+void GpuProfiler::beginFrame(uint32_t frameIndex, VkCommandBuffer commandBuffer, uint64_t frameNumber)
+{
+	currentFrame_ = frameIndex;
+	auto& frame = frames_[frameIndex];
+	frame.scopes.clear();
+	frame.passes.clear();
+	frame.depth = 0;
+	frame.passActive = false;
+	frame.frameNumber = frameNumber;
+	frame.recorded = enabled() || pipelineStatisticsEnabled();
+	if (enabled()) {
+		vkCmdResetQueryPool(commandBuffer, queryPool_, frameIndex * queriesPerFrame_, queriesPerFrame_);
+	}
+	if (pipelineStatisticsEnabled()) {
+		vkCmdResetQueryPool(commandBuffer, statisticsPool_, frameIndex * passesPerFrame_, passesPerFrame_);
+	}
+}
+
+std::optional<uint32_t> GpuProfiler::beginStatistics(VkCommandBuffer commandBuffer, std::string_view name)
+{
+	auto& frame = frames_[currentFrame_];
+	if (!pipelineStatisticsEnabled() || frame.passActive) return std::nullopt;
+	if (frame.passes.size() >= passesPerFrame_) {
+		droppedScopes_++;
+		return std::nullopt;
+	}
+	const auto index = static_cast<uint32_t>(frame.passes.size());
+	frame.passes.push_back(name);
+	frame.passActive = true;
+	vkCmdBeginQuery(commandBuffer, statisticsPool_, currentFrame_ * passesPerFrame_ + index, 0);
+	return index;
+}
+
+void GpuProfiler::endStatistics(VkCommandBuffer commandBuffer, uint32_t index)
+{
+	frames_[currentFrame_].passActive = false;
+	vkCmdEndQuery(commandBuffer, statisticsPool_, currentFrame_ * passesPerFrame_ + index);
+}
+
+void GpuProfiler::collectStatistics(uint32_t frameIndex)
+{
+	const auto& frame = frames_[frameIndex];
+	if (!pipelineStatisticsEnabled() || frame.passes.empty()) return;
+
+	constexpr size_t counterCount = sizeof(PipelineStatistics) / sizeof(uint64_t);
+	vkGetQueryPoolResults(device_, statisticsPool_, frameIndex * passesPerFrame_, static_cast<uint32_t>(frame.passes.size()),
+		statisticsResults_.size() * sizeof(uint64_t), statisticsResults_.data(), (counterCount + 1) * sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	FrameStatistics report{ .frameNumber = frame.frameNumber, .total = {} };
+	for (const auto [index, name] : frame.passes | std::views::enumerate) {
+		const uint64_t* pResult = &statisticsResults_[static_cast<size_t>(index) * (counterCount + 1)];
+		// һֵΪ availability
+		if (pResult[counterCount] == 0) {
+			droppedScopes_++;
+			continue;
+		}
+		PipelineStatistics statistics;
+		std::memcpy(&statistics, pResult, sizeof(statistics));
+		report.passes.emplace_back(name, statistics);
+		report.total += statistics;
+
+		auto& total = passStatistics_.try_emplace(name, PassStatisticsTotal{ .name = name, .count = 0, .sum = {} }).first->second;
+		total.count++;
+		total.sum += statistics;
+	}
+	lastFrameStatistics_ = std::move(report);
+}
+
+std::vector<GpuProfiler::PassStatisticsTotal> GpuProfiler::passStatistics() const
+{
+	return passStatistics_ | std::views::values | std::ranges::to<std::vector>();
+}
+
+GpuProfiler::Scope GpuProfiler::scope(VkCommandBuffer commandBuffer, std::string_view name)
+{
+	auto& frame = frames_[currentFrame_];
+	const auto beginQuery = static_cast<uint32_t>(frame.scopes.size() * 2);
+	if (!enabled() || beginQuery + 2 > queriesPerFrame_) {
+		if (enabled()) droppedScopes_++;
+		return Scope{ nullptr, VK_NULL_HANDLE, 0 };
+	}
+	frame.scopes.push_back(PendingScope{ .name = name, .depth = frame.depth, .beginQuery = beginQuery });
+	frame.depth++;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool_, currentFrame_ * queriesPerFrame_ + beginQuery);
+	return Scope{ this, commandBuffer, static_cast<uint32_t>(frame.scopes.size() - 1) };
+}
+
+void GpuProfiler::end(VkCommandBuffer commandBuffer, uint32_t index)
+{
+	auto& frame = frames_[currentFrame_];
+	frame.depth--;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool_,
+		currentFrame_ * queriesPerFrame_ + frame.scopes[index].beginQuery + 1);
+}
+
+GpuProfiler::Clock::time_point GpuProfiler::toCpuTime(uint64_t ticks) const
+{
+	// Чλ 64 ʱʱ, ƺĲֵ
+	const uint64_t delta = (ticks - calibrationTicks_) & timestampMask_;
+	const auto ns = static_cast<int64_t>(static_cast<double>(delta) * timestampPeriod_);
+	return calibrationTime_ + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(ns));
+}
+
+std::vector<TraceEvent> GpuProfiler::traceEvents(Clock::time_point origin) const
+{
+	using Microseconds = std::chrono::duration<double, std::micro>;
+	std::vector<TraceEvent> events;
+	events.reserve(events_.size());
+	for (size_t i = 0; i < events_.size(); i++) {
+		const auto& event = events_[(eventsBegin_ + i) % events_.size()];
+		events.push_back(TraceEvent{
+			.name = std::string(event.name),
+			.category = "gpu",
+			.tid = 3,
+			.startUs = Microseconds(event.start - origin).count(),
+			.durationUs = Microseconds(event.duration).count(),
+		});
+	}
+	return events;
+}
+
+std::vector<GpuProfiler::ScopeStats> GpuProfiler::scopeStats() const
+{
+	return stats_ | std::views::values | std::ranges::to<std::vector>();
+}
+
+/*
+ * Chase-Lev ȡ˫˶ ( Le, Pop, Cohen, Nardelli 2013  C11 ڴ汾)
+ * ӵ߳ bottom  push/pop (LIFO, Ѻ), ߳ top  steal (FIFO, ͵, һҲ)
+ * ֻжʣһԪʱӵ߲Ҫȡ߾ (CAS top)
+ * ̶, ʱ push ʧ, ɵߴ
+ */
+template<typename T, size_t capacity>
+	requires (std::has_single_bit(capacity) && std::is_trivially_copyable_v<T>)
+class WorkStealingDeque
+{
+public:
+	WorkStealingDeque() : top_(0), bottom_(0), buffer_(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+	// ֻӵ̵߳
+	bool push(T item)
+	{
+		const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+		const int64_t top = top_.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<int64_t>(capacity)) return false;
+		buffer_[bottom & (capacity - 1)].store(item, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom_.store(bottom + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// ֻӵ̵߳
+	std::optional<T> pop()
+	{
+		const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+		bottom_.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = top_.load(std::memory_order_relaxed);
+		if (top > bottom) {
+			// Ϊ
+			bottom_.store(bottom + 1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+		T item = buffer_[bottom & (capacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom) {
+			// һԪ, ȡ߾
+			const bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom_.store(bottom + 1, std::memory_order_relaxed);
+			if (!won) return std::nullopt;
+		}
+		return item;
+	}
+
+	// ̵߳
+	std::optional<T> steal()
+	{
+		int64_t top = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t bottom = bottom_.load(std::memory_order_acquire);
+		if (top >= bottom) return std::nullopt;
+		T item = buffer_[top & (capacity - 1)].load(std::memory_order_relaxed);
+		if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			// ȡ߻ӵ
+			return std::nullopt;
+		}
+		return item;
+	}
+
+private:
+	// top ȡ޸, bottom ֻӵ޸, ڲͬĻ
+	alignas(64) std::atomic<int64_t> top_;
+	alignas(64) std::atomic<int64_t> bottom_;
+	std::unique_ptr<std::atomic<T>[]> buffer_;
+};
+
+enum class ThreadAffinity
+{
+	// ߳ (߳ wait ʱ)
+	Any,
+	// ִֻ߳,  glfw ̵ֻ߳õ API
+	MainThread,
+};
+
+class JobCounter;
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter* pCounter;
+	ThreadAffinity affinity;
+};
+
+/*
+ * ɼ
+ * ÿڼϵύʱһ, ִʱһ, Ϊ 0 ʱ񱻷
+ * ׳ĵһ쳣ڼ,  JobSystem::wait ׳
+ */
+class JobCounter
+{
+public:
+	JobCounter() : pending_(0) {}
+
+	JobCounter(const JobCounter& other) = delete;
+	JobCounter(JobCounter&& other) noexcept = delete;
+	JobCounter& operator=(const JobCounter& other) = delete;
+	JobCounter& operator=(JobCounter&& other) noexcept = delete;
+
+	[[nodiscard]] bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> pending_;
+	//  waiters_  error_,  0 Ҳڽ,  JobSystem::finish
+	std::mutex mutex_;
+	std::vector<Job*> waiters_;
+	std::exception_ptr error_;
+};
+
+/*
+ * ȡ̳߳
+ * - ÿ߳ (߳, ±Ϊ 0) ӵһ Chase-Lev ˫˶, ߳ύԼĶ,
+ *   ʱ̵߳Ķȡ; ߳ (Ļص߳) ύĹ
+ * - ͨ JobCounter ʾ: runAfter ļΪ 0 ֮Żᱻ
+ * - wait ߳, ڵȴڼִ, еȴ񲻻
+ * - ̵ֻ߳߳ wait  runMainThreadJobs ִ, ύʱ mainThreadWakeup ߳ ( glfwPostEmptyEvent)
+ * - еĹ߳ atomic ˯, ύʱ
+ * ̹߳
+ */
+class JobSystem
+{
+public:
+	static constexpr uint32_t invalidThreadIndex = std::numeric_limits<uint32_t>::max();
+
+	// workerCount ߳, Ϊ 0 (̵߳ wait ִ)
+	explicit JobSystem(uint32_t workerCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem& other) = delete;
+	JobSystem(JobSystem&& other) noexcept = delete;
+	JobSystem& operator=(const JobSystem& other) = delete;
+	JobSystem& operator=(JobSystem&& other) noexcept = delete;
+
+	// ߳
+	[[nodiscard]] uint32_t threadCount() const { return static_cast<uint32_t>(queues_.size()); }
+	// ߳Ϊ 0, ߳Ϊ 1  threadCount() - 1, ߳Ϊ invalidThreadIndex
+	[[nodiscard]] static uint32_t currentThreadIndex() { return threadIndex_; }
+
+	void setMainThreadWakeup(std::function<void()> wakeup) { mainThreadWakeup_ = std::move(wakeup); }
+
+	// pCounter Ϊʱ, ɺһ
+	void run(std::function<void()> function, JobCounter* pCounter = nullptr, ThreadAffinity affinity = ThreadAffinity::Any);
+	// dependency Ϊ 0 ִ֮
+	void runAfter(JobCounter& dependency, std::function<void()> function, JobCounter* pCounter = nullptr,
+		ThreadAffinity affinity = ThreadAffinity::Any);
+	// ڵȴڼִ, Ϊ 0 ׳еĵһ쳣
+	// ߳ϻ׳ûме쳣
+	void wait(JobCounter& counter);
+	//  [0, count) гɲС grainSize 䲢ִ function(begin, end), ʱȫִ
+	void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function);
+	// ̵߳֡ѭе, ִ߳, ֮׳ûмеĵһ쳣
+	void runMainThreadJobs();
+
+private:
+	static constexpr size_t queueCapacity = 4096;
+	static inline thread_local uint32_t threadIndex_ = invalidThreadIndex;
+
+	std::vector<std::unique_ptr<WorkStealingDeque<Job*, queueCapacity>>> queues_;
+	std::mutex sharedMutex_;
+	std::vector<Job*> sharedJobs_;
+	std::mutex mainThreadMutex_;
+	std::vector<Job*> mainThreadJobs_;
+	std::function<void()> mainThreadWakeup_;
+	// ûм׳ĵһ쳣, ߳ wait  runMainThreadJobs ׳
+	std::mutex errorMutex_;
+	std::exception_ptr unhandledError_;
+	// ÿύһ, еĹ߳˯
+	std::atomic<uint32_t> wakeups_;
+	// , ʱֹͣ߳
+	std::vector<std::jthread> workers_;
+
+	void workerLoop(std::stop_token stopToken, uint32_t threadIndex);
+	void schedule(Job* pJob);
+	// ԼĶ, , ̵߳Ķе˳һִ, ûʱ false
+	bool runOne(uint32_t threadIndex);
+	Job* findJob(uint32_t threadIndex);
+	void execute(Job* pJob);
+	void finish(JobCounter& counter, std::exception_ptr error);
+	void rethrowUnhandledError();
+};
+
+JobSystem::JobSystem(uint32_t workerCount) : wakeups_(0)
+{
+	threadIndex_ = 0;
+	for (uint32_t i = 0; i <= workerCount; i++) {
+		queues_.push_back(std::make_unique<WorkStealingDeque<Job*, queueCapacity>>());
+	}
+	for (uint32_t i = 1; i <= workerCount; i++) {
+		workers_.emplace_back([this, i](std::stop_token stopToken) { workerLoop(stopToken, i); });
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	for (auto& worker : workers_) {
+		worker.request_stop();
+	}
+	wakeups_.fetch_add(1, std::memory_order_release);
+	wakeups_.notify_all();
+	workers_.clear();
+
+	// ûִеֱӶ
+	for (const auto& queue : queues_) {
+		while (const auto pJob = queue->steal()) delete *pJob;
+	}
+	for (const auto pJob : sharedJobs_) delete pJob;
+	for (const auto pJob : mainThreadJobs_) delete pJob;
+	threadIndex_ = invalidThreadIndex;
+}
+
+void JobSystem::run(std::function<void()> function, JobCounter* pCounter, ThreadAffinity affinity)
+{
+	if (pCounter != nullptr) pCounter->pending_.fetch_add(1, std::memory_order_relaxed);
+	schedule(new Job{ .function = std::move(function), .pCounter = pCounter, .affinity = affinity });
+}
+
+void JobSystem::runAfter(JobCounter& dependency, std::function<void()> function, JobCounter* pCounter, ThreadAffinity affinity)
+{
+	if (pCounter != nullptr) pCounter->pending_.fetch_add(1, std::memory_order_relaxed);
+	auto pJob = new Job{ .function = std::move(function), .pCounter = pCounter, .affinity = affinity };
+	{
+		//  finish ͬһڼ, ©ǡڴʱɵ
+		std::lock_guard lock(dependency.mutex_);
+		if (dependency.pending_.load(std::memory_order_acquire) != 0) {
+			dependency.waiters_.push_back(pJob);
+			return;
+		}
+	}
+	schedule(pJob);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	const uint32_t threadIndex = threadIndex_;
+	while (!counter.done()) {
+		if (threadIndex == invalidThreadIndex || !runOne(threadIndex)) {
+			std::this_thread::yield();
+		}
+	}
+	// ȴ finish ͷ֮ſԱ
+	{
+		std::lock_guard lock(counter.mutex_);
+		if (counter.error_ != nullptr) {
+			std::rethrow_exception(std::exchange(counter.error_, nullptr));
+		}
+	}
+	if (threadIndex == 0) rethrowUnhandledError();
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function)
+{
+	if (count == 0) return;
+	// ÿ̷ֵ߳, ȡ
+	const size_t chunkSize = std::max({ grainSize, size_t{ 1 }, count / (threadCount() * 4) });
+	if (chunkSize >= count) {
+		function(0, count);
+		return;
+	}
+	JobCounter counter;
+	// һ߳Լִ
+	for (size_t begin = chunkSize; begin < count; begin += chunkSize) {
+		const size_t end = std::min(begin + chunkSize, count);
+		run([&function, begin, end] { function(begin, end); }, &counter);
+	}
+	std::exception_ptr error;
+	try {
+		function(0, chunkSize);
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+	// ʹԼʧҲҪ,  function  counter
+	wait(counter);
+	if (error != nullptr) std::rethrow_exception(error);
+}
+
+void JobSystem::runMainThreadJobs()
+{
+	std::vector<Job*> jobs;
+	{
+		std::lock_guard lock(mainThreadMutex_);
+		jobs.swap(mainThreadJobs_);
+	}
+	for (const auto pJob : jobs) {
+		execute(pJob);
+	}
+	rethrowUnhandledError();
+}
+
+void JobSystem::workerLoop(std::stop_token stopToken, uint32_t threadIndex)
+{
+	threadIndex_ = threadIndex;
+	while (!stopToken.stop_requested()) {
+		// ȶ wakeups_ , Ҳڼµύʱ wait , ©
+		const uint32_t seen = wakeups_.load(std::memory_order_acquire);
+		if (runOne(threadIndex)) continue;
+		// ʱ request_stop  wakeups_: ֵ֮ʱһֹܿͣ,  wait 
+		if (stopToken.stop_requested()) break;
+		wakeups_.wait(seen, std::memory_order_acquire);
+	}
+}
+
+void JobSystem::schedule(Job* pJob)
+{
+	if (pJob->affinity == ThreadAffinity::MainThread) {
+		{
+			std::lock_guard lock(mainThreadMutex_);
+			mainThreadJobs_.push_back(pJob);
+		}
+		if (mainThreadWakeup_) mainThreadWakeup_();
+		return;
+	}
+
+	const uint32_t threadIndex = threadIndex_;
+	if (threadIndex == invalidThreadIndex || !queues_[threadIndex]->push(pJob)) {
+		// ⲿ߳ύ, ԼĶ
+		std::lock_guard lock(sharedMutex_);
+		sharedJobs_.push_back(pJob);
+	}
+	wakeups_.fetch_add(1, std::memory_order_release);
+	wakeups_.notify_one();
+}
+
+bool JobSystem::runOne(uint32_t threadIndex)
+{
+	Job* pJob = findJob(threadIndex);
+	if (pJob == nullptr) return false;
+	execute(pJob);
+	return true;
+}
+
+Job* JobSystem::findJob(uint32_t threadIndex)
+{
+	if (threadIndex == 0) {
+		std::lock_guard lock(mainThreadMutex_);
+		if (!mainThreadJobs_.empty()) {
+			Job* pJob = mainThreadJobs_.back();
+			mainThreadJobs_.pop_back();
+			return pJob;
+		}
+	}
+	if (const auto pJob = queues_[threadIndex]->pop()) return *pJob;
+	{
+		std::lock_guard lock(sharedMutex_);
+		if (!sharedJobs_.empty()) {
+			Job* pJob = sharedJobs_.back();
+			sharedJobs_.pop_back();
+			return pJob;
+		}
+	}
+	// һ߳̿ʼȡ, ̶߳ȥ͵ͬһ
+	const auto count = static_cast<uint32_t>(queues_.size());
+	for (uint32_t i = 1; i < count; i++) {
+		if (const auto pJob = queues_[(threadIndex + i) % count]->steal()) return *pJob;
+	}
+	return nullptr;
+}
+
+void JobSystem::execute(Job* pJob)
+{
+	const std::unique_ptr<Job> job(pJob);
+	std::exception_ptr error;
+	try {
+		job->function();
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+	if (job->pCounter != nullptr) {
+		finish(*job->pCounter, error);
+	}
+	else if (error != nullptr) {
+		// ûмʱ߳, ֻһ
+		std::lock_guard lock(errorMutex_);
+		if (unhandledError_ == nullptr) unhandledError_ = error;
+	}
+}
+
+void JobSystem::finish(JobCounter& counter, std::exception_ptr error)
+{
+	std::vector<Job*> ready;
+	{
+		std::lock_guard lock(counter.mutex_);
+		if (error != nullptr && counter.error_ == nullptr) counter.error_ = error;
+		if (counter.pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			ready.swap(counter.waiters_);
+		}
+	}
+	// ͷ֮ٷ counter, ȴ߿Ѿ
+	for (const auto pJob : ready) {
+		schedule(pJob);
+	}
+}
+
+void JobSystem::rethrowUnhandledError()
+{
+	std::exception_ptr error;
+	{
+		std::lock_guard lock(errorMutex_);
+		error = std::exchange(unhandledError_, nullptr);
+	}
+	if (error != nullptr) std::rethrow_exception(error);
+}
+
+/*
+ * ߳¼ secondary command buffer
+ * command pool ͬʱ߳ʹ,  job system ÿ߳ÿ in flight ֡ӵԼ command pool,
+ * ֡ʼʱ reset,  command buffer ֮֡и
+ * - ¼ͨ parallelFor ָ߳, ߳Ҳ¼, ֻһʱֱڵ߳¼
+ * - ĸ߳¼ǲȷ, ǰ˳ primary ִ
+ * - ׳쳣ڵ߳ϰ˳׳
+ * ڹִ߳, ܵ GpuProfiler ȷ̰߳ȫĶ
+ */
+class CommandRecorder
+{
+public:
+	using RecordFunction = std::function<void(VkCommandBuffer)>;
+
+	CommandRecorder(VkDevice device, JobSystem& jobSystem, uint32_t queueFamilyIndex, uint32_t framesInFlight);
+	~CommandRecorder();
+
+	CommandRecorder(const CommandRecorder& other) = delete;
+	CommandRecorder(CommandRecorder&& other) noexcept = delete;
+	CommandRecorder& operator=(const CommandRecorder& other) = delete;
+	CommandRecorder& operator=(CommandRecorder&& other) noexcept = delete;
+
+	// ȴ֡ fence ֮, reset ̵֡߳ command pool
+	void beginFrame(uint32_t frameIndex);
+	// ¼ tasks  tasks ˳ primary  vkCmdExecuteCommands, ֻ job system ߳ϵ
+	void record(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo& inheritance,
+		std::span<const RecordFunction> tasks);
+
+private:
+	struct ThreadPool
+	{
+		VkCommandPool commandPool;
+		std::vector<VkCommandBuffer> commandBuffers;
+		// ֡Ѿʹõ command buffer 
+		uint32_t used;
+	};
+
+	VkDevice device_;
+	JobSystem& jobSystem_;
+	uint32_t threadCount_;
+	// ±Ϊ frameIndex * threadCount_ + threadIndex
+	std::vector<ThreadPool> pools_;
+	uint32_t currentFrame_;
+
+	VkCommandBuffer recordTask(const VkCommandBufferInheritanceInfo& inheritance, const RecordFunction& task);
+	VkCommandBuffer acquireCommandBuffer(ThreadPool& pool);
+};
+
+CommandRecorder::CommandRecorder(VkDevice device, JobSystem& jobSystem, uint32_t queueFamilyIndex, uint32_t framesInFlight)
+	: device_(device), jobSystem_(jobSystem), threadCount_(jobSystem.threadCount()), currentFrame_(0)
+{
+	// ÿ֡¼, Ϊ transient
+	const VkCommandPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = queueFamilyIndex,
+	};
+	// ȷ pools_ ٴ, ;ʧʱֻҪվ
+	pools_.assign(framesInFlight * threadCount_, ThreadPool{});
+	for (auto& pool : pools_) {
+		if (vkCreateCommandPool(device_, &poolCreateInfo, nullptr, &pool.commandPool) != VK_SUCCESS) {
+			for (const auto& created : pools_) {
+				vkDestroyCommandPool(device_, created.commandPool, nullptr);
+			}
+			throw std::runtime_error("failed to create recording command pool");
+		}
+	}
+}
+
+CommandRecorder::~CommandRecorder()
+{
+	// command buffer  pool һͷ
+	for (const auto& pool : pools_) {
+		vkDestroyCommandPool(device_, pool.commandPool, nullptr);
+	}
+}
+
+void CommandRecorder::beginFrame(uint32_t frameIndex)
+{
+	currentFrame_ = frameIndex;
+	for (uint32_t i = 0; i < threadCount_; i++) {
+		auto& pool = pools_[frameIndex * threadCount_ + i];
+		if (pool.used == 0) continue;
+		vkResetCommandPool(device_, pool.commandPool, 0);
+		pool.used = 0;
+	}
+}
+
+void CommandRecorder::record(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo& inheritance,
+	std::span<const RecordFunction> tasks)
+{
+	if (tasks.empty()) return;
+
+	// ÿдԼ±, ִ˳¼Ƶ߳޹
+	std::vector<VkCommandBuffer> recorded(tasks.size(), VK_NULL_HANDLE);
+	std::vector<std::exception_ptr> errors(tasks.size(), nullptr);
+	jobSystem_.parallelFor(tasks.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			try {
+				recorded[i] = recordTask(inheritance, tasks[i]);
+			}
+			catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+	});
+
+	for (const auto& error : errors) {
+		if (error != nullptr) std::rethrow_exception(error);
+	}
+	vkCmdExecuteCommands(primary, static_cast<uint32_t>(recorded.size()), recorded.data());
+}
+
+VkCommandBuffer CommandRecorder::recordTask(const VkCommandBufferInheritanceInfo& inheritance, const RecordFunction& task)
+{
+	const uint32_t threadIndex = JobSystem::currentThreadIndex();
+	if (threadIndex >= threadCount_) {
+		throw std::runtime_error("command buffers must be recorded on a job system thread");
+	}
+	const VkCommandBuffer commandBuffer = acquireCommandBuffer(pools_[currentFrame_ * threadCount_ + threadIndex]);
+	// ̳ render pass  dynamic rendering (pNext ϵ VkCommandBufferInheritanceRenderingInfo) ʱȾִ
+	bool renderPassContinue = inheritance.renderPass != VK_NULL_HANDLE;
+	for (auto pNext = static_cast<const VkBaseInStructure*>(inheritance.pNext); pNext != nullptr; pNext = pNext->pNext) {
+		renderPassContinue |= pNext->sType == VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+	}
+	const VkCommandBufferBeginInfo beginInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+			(renderPassContinue ? VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0u),
+		.pInheritanceInfo = &inheritance,
+	};
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording secondary command buffer");
+	}
+	task(commandBuffer);
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record secondary command buffer");
+	}
+	return commandBuffer;
+}
+
+VkCommandBuffer CommandRecorder::acquireCommandBuffer(ThreadPool& pool)
+{
+	if (pool.used == pool.commandBuffers.size()) {
+		const VkCommandBufferAllocateInfo allocateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = pool.commandPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+			.commandBufferCount = 1,
+		};
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(device_, &allocateInfo, &commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate secondary command buffer");
+		}
+		pool.commandBuffers.push_back(commandBuffer);
+	}
+	return pool.commandBuffers[pool.used++];
+}
+
+/*
+ * device memory 
+ * vkAllocateMemory , ͬʱڵķ maxMemoryAllocationCount  (ֻܶ 4096)
+ * ÿһڴ (block),  buddy 㷨зָԴ
+ * - ÿ memory type ֱάԼ block
+ * - Դ (buffer, linear image) ͷԴ (optimal image) ڲͬ block ,
+ *   Զ, ҲͲҪ bufferImageGranularity
+ * - buddy гĿƫС, ֻҪ鲻С alignment Ȼ
+ * -  block һС (ʽҪ) Դ (dedicated)
+ */
+class DeviceMemoryAllocator
+{
+public:
+	// Դ;, ѡ memory type
+	enum class MemoryUsage
+	{
+		// ֻ GPU :  DEVICE_LOCAL
+		GpuOnly,
+		// CPU дһ, GPU ȡ (staging): HOST_VISIBLE, ռ DEVICE_LOCAL
+		Upload,
+		// CPU Ƶд, GPU ȡ (uniform ): HOST_VISIBLE,  DEVICE_LOCAL
+		Dynamic,
+		// GPU д, CPU : HOST_VISIBLE,  HOST_CACHED
+		Readback,
+	};
+	enum class ResourceKind
+	{
+		Linear,
+		Optimal,
+	};
+
+private:
+	struct Block;
+
+public:
+	struct Allocation
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		// HOST_VISIBLE ڴһֱ map, ֱӸ÷ʼַ
+		void* mapped = nullptr;
+		uint32_t memoryTypeIndex = 0;
+
+	private:
+		friend class DeviceMemoryAllocator;
+		// dedicated ʱΪ nullptr
+		Block* block = nullptr;
+		uint32_t order = 0;
+	};
+
+	struct HeapStats
+	{
+		VkDeviceSize heapSize = 0;
+		// ڴ (block + dedicated)
+		VkDeviceSize allocatedBytes = 0;
+		// ָԴڴ ( buddy ȡ˷ѵĲ)
+		VkDeviceSize usedBytes = 0;
+		uint32_t blockCount = 0;
+		uint32_t dedicatedCount = 0;
+		uint32_t allocationCount = 0;
+	};
+
+	DeviceMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = 64 * 1024 * 1024);
+	~DeviceMemoryAllocator();
+
+	DeviceMemoryAllocator(const DeviceMemoryAllocator& other) = delete;
+	DeviceMemoryAllocator(DeviceMemoryAllocator&& other) noexcept = delete;
+	DeviceMemoryAllocator& operator=(const DeviceMemoryAllocator& other) = delete;
+	DeviceMemoryAllocator& operator=(DeviceMemoryAllocator&& other) noexcept = delete;
+
+	Allocation allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, ResourceKind kind, bool dedicated = false);
+	void free(Allocation& allocation) noexcept;
+
+	// ѯԴڴ, 䲢
+	Allocation allocateForBuffer(VkBuffer buffer, MemoryUsage usage);
+	Allocation allocateForImage(VkImage image, MemoryUsage usage, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL);
+
+	[[nodiscard]] std::vector<HeapStats> heapStats() const;
+	[[nodiscard]] const VkPhysicalDeviceMemoryProperties& memoryProperties() const { return memoryProperties_; }
+
+private:
+	// buddy С,  order ׵ĿСΪ minAllocationSize << order
+	static constexpr VkDeviceSize minAllocationSize = 256;
+
+	struct Block
+	{
+		VkDeviceMemory memory;
+		void* mapped;
+		uint32_t memoryTypeIndex;
+		ResourceKind kind;
+		uint32_t maxOrder;
+		// freeOffsets[order]: ýппƫ,  set Աͷʱ buddy
+		std::vector<std::set<VkDeviceSize>> freeOffsets;
+		VkDeviceSize usedBytes;
+	};
+
+	VkDevice device_;
+	VkPhysicalDeviceMemoryProperties memoryProperties_;
+	VkDeviceSize blockSize_;
+	uint32_t maxAllocationCount_;
+	// ǰڵ vkAllocateMemory 
+	uint32_t deviceAllocationCount_;
+	std::vector<std::unique_ptr<Block>> blocks_;
+	std::vector<HeapStats> heapStats_;
+	mutable std::mutex mutex_;
+
+	//  typeBits ; memory type, ʳ̶, ǰķʧ () ʱԺ
+	[[nodiscard]] std::vector<uint32_t> findMemoryTypes(uint32_t typeBits, MemoryUsage usage) const;
+	[[nodiscard]] VkDeviceSize blockSizeOf(uint32_t memoryTypeIndex) const;
+	[[nodiscard]] HeapStats& heapStatsOf(uint32_t memoryTypeIndex);
+
+	// ڴ治ʱ VK_NULL_HANDLE
+	VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** ppMapped);
+	void freeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex) noexcept;
+
+	static std::optional<VkDeviceSize> allocateFromBlock(Block& block, uint32_t order);
+	static void freeToBlock(Block& block, VkDeviceSize offset, uint32_t order);
+};
+
+DeviceMemoryAllocator::DeviceMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+	: device_(device), blockSize_(std::bit_floor(blockSize)), deviceAllocationCount_(0)
+{
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties_);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	maxAllocationCount_ = properties.limits.maxMemoryAllocationCount;
+
+	heapStats_.resize(memoryProperties_.memoryHeapCount);
+	for (uint32_t i = 0; i < memoryProperties_.memoryHeapCount; i++) {
+		heapStats_[i].heapSize = memoryProperties_.memoryHeaps[i].size;
+	}
+}
+
+DeviceMemoryAllocator::~DeviceMemoryAllocator()
+{
+	// ʱûͷŵ dedicated й©,  validation layer 
+	for (const auto& block : blocks_) {
+		vkFreeMemory(device_, block->memory, nullptr);
+	}
+}
+
+std::vector<uint32_t> DeviceMemoryAllocator::findMemoryTypes(uint32_t typeBits, MemoryUsage usage) const
+{
+	/*
+	 * required: е
+	 * preferred: ÿһһ
+	 * avoided: ÿһһ
+	 *  coherent ڴҪֶ flush/invalidate, ͳһҪ CPU ɼڴ coherent 
+	 */
+	VkMemoryPropertyFlags required = 0, preferred = 0, avoided = 0;
+	switch (usage) {
+	case MemoryUsage::GpuOnly:
+		preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		avoided = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		break;
+	case MemoryUsage::Upload:
+		required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		avoided = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		break;
+	case MemoryUsage::Dynamic:
+		required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		break;
+	case MemoryUsage::Readback:
+		required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		break;
+	}
+	// protected  lazily allocated ڴ;, һ
+	avoided |= VK_MEMORY_PROPERTY_PROTECTED_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+	std::vector<std::pair<int, uint32_t>> candidates;
+	for (uint32_t i = 0; i < memoryProperties_.memoryTypeCount; i++) {
+		const auto flags = memoryProperties_.memoryTypes[i].propertyFlags;
+		if (!(typeBits & (1u << i)) || (flags & required) != required) continue;
+		if (flags & (VK_MEMORY_PROPERTY_PROTECTED_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)) continue;
+		const int score = std::popcount(flags & preferred) - std::popcount(flags & avoided);
+		candidates.emplace_back(score, i);
+	}
+	// ͬʱ˳ (һܸõǰ)
+	std::ranges::stable_sort(candidates, std::ranges::greater{}, &std::pair<int, uint32_t>::first);
+	return candidates | std::views::values | std::ranges::to<std::vector<uint32_t>>();
+}
+
+VkDeviceSize DeviceMemoryAllocator::blockSizeOf(uint32_t memoryTypeIndex) const
+{
+	// С ( 256MB  BAR)  block ѵ 1/8
+	const auto heapSize = memoryProperties_.memoryHeaps[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex].size;
+	return std::max(minAllocationSize, std::min(blockSize_, std::bit_floor(heapSize / 8)));
+}
+
+DeviceMemoryAllocator::HeapStats& DeviceMemoryAllocator::heapStatsOf(uint32_t memoryTypeIndex)
+{
+	return heapStats_[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex];
+}
+
+VkDeviceMemory DeviceMemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** ppMapped)
+{
+	if (deviceAllocationCount_ >= maxAllocationCount_) {
+		throw std::runtime_error(std::format("maxMemoryAllocationCount ({}) reached", maxAllocationCount_));
+	}
+
+	const VkMemoryAllocateInfo allocateInfo{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.allocationSize = size,
+		.memoryTypeIndex = memoryTypeIndex,
+	};
+	VkDeviceMemory memory;
+	switch (vkAllocateMemory(device_, &allocateInfo, nullptr, &memory)) {
+	case VK_SUCCESS:
+		break;
+	case VK_ERROR_OUT_OF_DEVICE_MEMORY:
+	case VK_ERROR_OUT_OF_HOST_MEMORY:
+		return VK_NULL_HANDLE;
+	default:
+		throw std::runtime_error("failed to allocate device memory");
+	}
+
+	*ppMapped = nullptr;
+	if (memoryProperties_.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		if (vkMapMemory(device_, memory, 0, VK_WHOLE_SIZE, 0, ppMapped) != VK_SUCCESS) {
+			vkFreeMemory(device_, memory, nullptr);
+			throw std::runtime_error("failed to map device memory");
+		}
+	}
+
+	deviceAllocationCount_++;
+	heapStatsOf(memoryTypeIndex).allocatedBytes += size;
+	return memory;
+}
+
+void DeviceMemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex) noexcept
+{
+	// ͷʱԶ unmap
+	vkFreeMemory(device_, memory, nullptr);
+	deviceAllocationCount_--;
+	heapStatsOf(memoryTypeIndex).allocatedBytes -= size;
+}
+
+std::optional<VkDeviceSize> DeviceMemoryAllocator::allocateFromBlock(Block& block, uint32_t order)
+{
+	// ҵС order Сп, 𼶶԰, һŻصһ׵Ŀб
+	auto current = order;
+	while (current <= block.maxOrder && block.freeOffsets[current].empty()) {
+		current++;
+	}
+	if (current > block.maxOrder) return std::nullopt;
+
+	const auto offset = *block.freeOffsets[current].begin();
+	block.freeOffsets[current].erase(block.freeOffsets[current].begin());
+	while (current > order) {
+		current--;
+		block.freeOffsets[current].insert(offset + (minAllocationSize << current));
+	}
+	block.usedBytes += minAllocationSize << order;
+	return offset;
+}
+
+void DeviceMemoryAllocator::freeToBlock(Block& block, VkDeviceSize offset, uint32_t order)
+{
+	block.usedBytes -= minAllocationSize << order;
+	// buddy ҲʱϲΪһ׵Ŀ, ֱ buddy ռûߺϲ block
+	while (order < block.maxOrder) {
+		const auto buddy = offset ^ (minAllocationSize << order);
+		const auto pBuddy = block.freeOffsets[order].find(buddy);
+		if (pBuddy == block.freeOffsets[order].end()) break;
+		block.freeOffsets[order].erase(pBuddy);
+		offset = std::min(offset, buddy);
+		order++;
+	}
+	block.freeOffsets[order].insert(offset);
+}
+
+DeviceMemoryAllocator::Allocation DeviceMemoryAllocator::allocate(const VkMemoryRequirements& requirements,
+	MemoryUsage usage, ResourceKind kind, bool dedicated)
+{
+	std::lock_guard lock{ mutex_ };
+
+	const auto roundedSize = std::bit_ceil(std::max({ requirements.size, requirements.alignment, minAllocationSize }));
+	const auto order = static_cast<uint32_t>(std::countr_zero(roundedSize / minAllocationSize));
+
+	for (const auto typeIndex : findMemoryTypes(requirements.memoryTypeBits, usage)) {
+		auto& stats = heapStatsOf(typeIndex);
+		const auto blockSize = blockSizeOf(typeIndex);
+
+		if (dedicated || roundedSize > blockSize / 2) {
+			void* mapped;
+			const auto memory = allocateDeviceMemory(requirements.size, typeIndex, &mapped);
+			if (memory == VK_NULL_HANDLE) continue;
+			stats.usedBytes += requirements.size;
+			stats.dedicatedCount++;
+			stats.allocationCount++;
+
+			Allocation allocation;
+			allocation.memory = memory;
+			allocation.size = requirements.size;
+			allocation.mapped = mapped;
+			allocation.memoryTypeIndex = typeIndex;
+			return allocation;
+		}
+
+		auto fillAllocation = [&](Block& block, VkDeviceSize offset) {
+			stats.usedBytes += roundedSize;
+			stats.allocationCount++;
+
+			Allocation allocation;
+			allocation.memory = block.memory;
+			allocation.offset = offset;
+			allocation.size = requirements.size;
+			allocation.mapped = block.mapped == nullptr ? nullptr : static_cast<char*>(block.mapped) + offset;
+			allocation.memoryTypeIndex = typeIndex;
+			allocation.block = &block;
+			allocation.order = order;
+			return allocation;
+		};
+
+		for (const auto& block : blocks_) {
+			if (block->memoryTypeIndex != typeIndex || block->kind != kind) continue;
+			if (const auto offset = allocateFromBlock(*block, order); offset.has_value()) {
+				return fillAllocation(*block, *offset);
+			}
+		}
+
+		// е block Ų, µ block
+		void* mapped;
+		const auto memory = allocateDeviceMemory(blockSize, typeIndex, &mapped);
+		if (memory == VK_NULL_HANDLE) continue;
+		const auto maxOrder = static_cast<uint32_t>(std::countr_zero(blockSize / minAllocationSize));
+		auto& block = *blocks_.emplace_back(std::make_unique<Block>(Block{
+			.memory = memory,
+			.mapped = mapped,
+			.memoryTypeIndex = typeIndex,
+			.kind = kind,
+			.maxOrder = maxOrder,
+			.freeOffsets = std::vector<std::set<VkDeviceSize>>(maxOrder + 1),
+			.usedBytes = 0,
+		}));
+		block.freeOffsets[maxOrder].insert(0);
+		stats.blockCount++;
+		return fillAllocation(block, *allocateFromBlock(block, order));
+	}
+	throw std::runtime_error(std::format("failed to allocate {} bytes of device memory", requirements.size));
+}
+
+void DeviceMemoryAllocator::free(Allocation& allocation) noexcept
+{
+	if (allocation.memory == VK_NULL_HANDLE) return;
+	std::lock_guard lock{ mutex_ };
+
+	auto& stats = heapStatsOf(allocation.memoryTypeIndex);
+	stats.allocationCount--;
+	if (allocation.block == nullptr) {
+		freeDeviceMemory(allocation.memory, allocation.size, allocation.memoryTypeIndex);
+		stats.usedBytes -= allocation.size;
+		stats.dedicatedCount--;
+	}
+	else {
+		auto& block = *allocation.block;
+		freeToBlock(block, allocation.offset, allocation.order);
+		stats.usedBytes -= minAllocationSize << allocation.order;
+
+		// block ֮, ͬ block ͹黹, űⷴ
+		if (block.usedBytes == 0) {
+			const auto sameKind = std::ranges::count_if(blocks_, [&block](const auto& other) {
+				return other->memoryTypeIndex == block.memoryTypeIndex && other->kind == block.kind;
+			});
+			if (sameKind > 1) {
+				freeDeviceMemory(block.memory, minAllocationSize << block.maxOrder, block.memoryTypeIndex);
+				stats.blockCount--;
+				std::erase_if(blocks_, [&block](const auto& other) { return other.get() == &block; });
+			}
+		}
+	}
+	allocation = Allocation{};
+}
+
+DeviceMemoryAllocator::Allocation DeviceMemoryAllocator::allocateForBuffer(VkBuffer buffer, MemoryUsage usage)
+{
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(device_, buffer, &requirements);
+	auto allocation = allocate(requirements, usage, ResourceKind::Linear);
+	if (vkBindBufferMemory(device_, buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+		free(allocation);
+		throw std::runtime_error("failed to bind buffer memory");
+	}
+	return allocation;
+}
+
+DeviceMemoryAllocator::Allocation DeviceMemoryAllocator::allocateForImage(VkImage image, MemoryUsage usage, VkImageTiling tiling)
+{
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(device_, image, &requirements);
+	const auto kind = tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::Optimal : ResourceKind::Linear;
+	auto allocation = allocate(requirements, usage, kind);
+	if (vkBindImageMemory(device_, image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+		free(allocation);
+		throw std::runtime_error("failed to bind image memory");
+	}
+	return allocation;
+}
+
+std::vector<DeviceMemoryAllocator::HeapStats> DeviceMemoryAllocator::heapStats() const
+{
+	std::lock_guard lock{ mutex_ };
+	return heapStats_;
+}
+
+/*
+ * ȫ bindless Դ (VK_EXT_descriptor_indexing)
+ *  sampled image, sampler, storage buffer ͬһ descriptor set  binding ,
+ * Դ± (handle) ʾ, ɫͨ push constant ȴ±ֱ, ÿֻ֡Ҫһ set
+ * - binding  UPDATE_AFTER_BIND  PARTIALLY_BOUND: set 󶨺ȻдµԴ, ûдĲλᱻʾͲҪЧ
+ * - һ binding (storage buffer) 鳤ڷ set ʱָ (VARIABLE_DESCRIPTOR_COUNT)
+ * - дȻ, ÿ֡¼֮ǰͳһ vkUpdateDescriptorSets
+ * - ͷŵ±Ҫʹùִ֮֡Żᱻ, ɽĻշʽͬ
+ * ߳ӺͷԴ
+ */
+class BindlessHeap
+{
+public:
+	enum class ResourceKind : uint32_t
+	{
+		SampledImage = 0,
+		Sampler = 1,
+		StorageBuffer = 2,
+	};
+
+	// ȶ handle, index ɫ±, ͬԴԱ
+	template<ResourceKind kind>
+	struct Handle
+	{
+		uint32_t index;
+	};
+	using TextureHandle = Handle<ResourceKind::SampledImage>;
+	using SamplerHandle = Handle<ResourceKind::Sampler>;
+	using BufferHandle = Handle<ResourceKind::StorageBuffer>;
+
+	// ÿԴ鳤
+	struct Capacity
+	{
+		uint32_t sampledImages;
+		uint32_t samplers;
+		uint32_t storageBuffers;
+	};
+
+	// push constant ĴС, й߹ͬһ pipeline layout
+	static constexpr uint32_t pushConstantSize = 128;
+
+	BindlessHeap(VkDevice device, const Capacity& capacity, uint32_t framesInFlight);
+	~BindlessHeap();
+
+	//  vkGetDescriptorSetLayoutSupport (1.1  VK_KHR_maintenance3)  layout ܷ񴴽
+	//  per-stage  per-set ƶʱȻΪʵصԭ򲻱֧
+	[[nodiscard]] static bool layoutSupported(VkDevice device, const Capacity& capacity,
+		PFN_vkGetDescriptorSetLayoutSupportKHR getLayoutSupport);
+
+	BindlessHeap(const BindlessHeap& other) = delete;
+	BindlessHeap(BindlessHeap&& other) noexcept = delete;
+	BindlessHeap& operator=(const BindlessHeap& other) = delete;
+	BindlessHeap& operator=(BindlessHeap&& other) noexcept = delete;
+
+	[[nodiscard]] VkDescriptorSetLayout setLayout() const { return setLayout_; }
+	[[nodiscard]] VkPipelineLayout pipelineLayout() const { return pipelineLayout_; }
+	[[nodiscard]] const Capacity& capacity() const { return capacity_; }
+
+	TextureHandle addTexture(VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	SamplerHandle addSampler(VkSampler sampler);
+	BufferHandle addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+	// Դɵ, Ҫ֤ framesInFlight ֮֡ڲᱻ
+	template<ResourceKind kind>
+	void remove(Handle<kind> handle) { retire(kind, handle.index); }
+
+	// ÿ֡¼֮ǰ: տԸõ±, д뻺 descriptor
+	void beginFrame(uint64_t frameNumber);
+	// ÿ command buffer ( secondary) Ҫ԰һ
+	void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const;
+
+private:
+	struct PendingWrite
+	{
+		ResourceKind kind;
+		uint32_t index;
+		VkDescriptorImageInfo imageInfo;
+		VkDescriptorBufferInfo bufferInfo;
+	};
+
+	struct RetiredIndex
+	{
+		ResourceKind kind;
+		uint32_t index;
+		uint64_t retiredAtFrame;
+	};
+
+	// ÿԴ±: ͷźյ±, ûʱȡµ
+	struct IndexAllocator
+	{
+		uint32_t next;
+		std::vector<uint32_t> freeIndices;
+	};
+
+	VkDevice device_;
+	Capacity capacity_;
+	uint32_t framesInFlight_;
+	VkDescriptorSetLayout setLayout_;
+	VkPipelineLayout pipelineLayout_;
+	VkDescriptorPool descriptorPool_;
+	VkDescriptorSet descriptorSet_;
+
+	std::mutex mutex_;
+	std::array<IndexAllocator, 3> indices_;
+	std::vector<PendingWrite> pendingWrites_;
+	std::vector<RetiredIndex> retired_;
+	uint64_t frameNumber_;
+
+	uint32_t allocateIndex(ResourceKind kind);
+	void retire(ResourceKind kind, uint32_t index);
+
+	//  layout ĴϢ callback, ּ֧ʹͬһ
+	template<typename Callback>
+	static void withLayoutCreateInfo(const Capacity& capacity, Callback&& callback);
+};
+
+template<typename Callback>
+void BindlessHeap::withLayoutCreateInfo(const Capacity& capacity, Callback&& callback)
+{
+	const std::array bindings{
+		VkDescriptorSetLayoutBinding{
+			.binding = static_cast<uint32_t>(ResourceKind::SampledImage),
+			.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+			.descriptorCount = capacity.sampledImages,
+			.stageFlags = VK_SHADER_STAGE_ALL,
+		},
+		VkDescriptorSetLayoutBinding{
+			.binding = static_cast<uint32_t>(ResourceKind::Sampler),
+			.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+			.descriptorCount = capacity.samplers,
+			.stageFlags = VK_SHADER_STAGE_ALL,
+		},
+		VkDescriptorSetLayoutBinding{
+			.binding = static_cast<uint32_t>(ResourceKind::StorageBuffer),
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = capacity.storageBuffers,
+			.stageFlags = VK_SHADER_STAGE_ALL,
+		},
+	};
+	constexpr VkDescriptorBindingFlagsEXT bindingFlags =
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+		VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+	// ֻһ binding ǿɱ䳤
+	const std::array<VkDescriptorBindingFlagsEXT, 3> flags{
+		bindingFlags,
+		bindingFlags,
+		bindingFlags | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT,
+	};
+	const VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+		.bindingCount = static_cast<uint32_t>(flags.size()),
+		.pBindingFlags = flags.data(),
+	};
+	const VkDescriptorSetLayoutCreateInfo layoutCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = &bindingFlagsCreateInfo,
+		.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT,
+		.bindingCount = static_cast<uint32_t>(bindings.size()),
+		.pBindings = bindings.data(),
+	};
+	callback(layoutCreateInfo);
+}
+
+bool BindlessHeap::layoutSupported(VkDevice device, const Capacity& capacity,
+	PFN_vkGetDescriptorSetLayoutSupportKHR getLayoutSupport)
+{
+	// ɱ䳤ȵ binding  descriptorCount Ϊ޼, ʵܷĳⷵ
+	VkDescriptorSetVariableDescriptorCountLayoutSupportEXT variableCountSupport{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_LAYOUT_SUPPORT_EXT,
+	};
+	VkDescriptorSetLayoutSupportKHR support{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_SUPPORT_KHR,
+		.pNext = &variableCountSupport,
+	};
+	withLayoutCreateInfo(capacity, [&](const VkDescriptorSetLayoutCreateInfo& createInfo) {
+		getLayoutSupport(device, &createInfo, &support);
+	});
+	return support.supported == VK_TRUE && variableCountSupport.maxVariableDescriptorCount >= capacity.storageBuffers;
+}
+
+BindlessHeap::BindlessHeap(VkDevice device, const Capacity& capacity, uint32_t framesInFlight)
+	: device_(device), capacity_(capacity), framesInFlight_(framesInFlight), setLayout_(VK_NULL_HANDLE),
+	pipelineLayout_(VK_NULL_HANDLE), descriptorPool_(VK_NULL_HANDLE), descriptorSet_(VK_NULL_HANDLE), indices_{}, frameNumber_(0)
+{
+	const VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = pushConstantSize,
+	};
+
+	const std::array poolSizes{
+		VkDescriptorPoolSize{ .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .descriptorCount = capacity_.sampledImages },
+		VkDescriptorPoolSize{ .type = VK_DESCRIPTOR_TYPE_SAMPLER, .descriptorCount = capacity_.samplers },
+		VkDescriptorPoolSize{ .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = capacity_.storageBuffers },
+	};
+	const VkDescriptorPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,
+		.maxSets = 1,
+		.poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+		.pPoolSizes = poolSizes.data(),
+	};
+
+	withLayoutCreateInfo(capacity_, [this](const VkDescriptorSetLayoutCreateInfo& createInfo) {
+		if (vkCreateDescriptorSetLayout(device_, &createInfo, nullptr, &setLayout_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create bindless descriptor set layout");
+		}
+	});
+	const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 1,
+		.pSetLayouts = &setLayout_,
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+	if (vkCreatePipelineLayout(device_, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout_) != VK_SUCCESS ||
+		vkCreateDescriptorPool(device_, &poolCreateInfo, nullptr, &descriptorPool_) != VK_SUCCESS) {
+		vkDestroyPipelineLayout(device_, pipelineLayout_, nullptr);
+		vkDestroyDescriptorSetLayout(device_, setLayout_, nullptr);
+		throw std::runtime_error("failed to create bindless pipeline layout or descriptor pool");
+	}
+
+	const VkDescriptorSetVariableDescriptorCountAllocateInfoEXT variableCountInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT,
+		.descriptorSetCount = 1,
+		.pDescriptorCounts = &capacity_.storageBuffers,
+	};
+	const VkDescriptorSetAllocateInfo allocateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext = &variableCountInfo,
+		.descriptorPool = descriptorPool_,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &setLayout_,
+	};
+	if (vkAllocateDescriptorSets(device_, &allocateInfo, &descriptorSet_) != VK_SUCCESS) {
+		vkDestroyDescriptorPool(device_, descriptorPool_, nullptr);
+		vkDestroyPipelineLayout(device_, pipelineLayout_, nullptr);
+		vkDestroyDescriptorSetLayout(device_, setLayout_, nullptr);
+		throw std::runtime_error("failed to allocate bindless descriptor set");
+	}
+}
+
+BindlessHeap::~BindlessHeap()
+{
+	// descriptor set  pool һͷ
+	vkDestroyDescriptorPool(device_, descriptorPool_, nullptr);
+	vkDestroyPipelineLayout(device_, pipelineLayout_, nullptr);
+	vkDestroyDescriptorSetLayout(device_, setLayout_, nullptr);
+}
+
+BindlessHeap::TextureHandle BindlessHeap::addTexture(VkImageView imageView, VkImageLayout layout)
+{
+	std::lock_guard lock{ mutex_ };
+	const uint32_t index = allocateIndex(ResourceKind::SampledImage);
+	pendingWrites_.push_back(PendingWrite{
+		.kind = ResourceKind::SampledImage,
+		.index = index,
+		.imageInfo = { .sampler = VK_NULL_HANDLE, .imageView = imageView, .imageLayout = layout },
+		.bufferInfo = {},
+	});
+	return TextureHandle{ index };
+}
+
+BindlessHeap::SamplerHandle BindlessHeap::addSampler(VkSampler sampler)
+{
+	std::lock_guard lock{ mutex_ };
+	const uint32_t index = allocateIndex(ResourceKind::Sampler);
+	pendingWrites_.push_back(PendingWrite{
+		.kind = ResourceKind::Sampler,
+		.index = index,
+		.imageInfo = { .sampler = sampler, .imageView = VK_NULL_HANDLE, .imageLayout = VK_IMAGE_LAYOUT_UNDEFINED },
+		.bufferInfo = {},
+	});
+	return SamplerHandle{ index };
+}
+
+BindlessHeap::BufferHandle BindlessHeap::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	std::lock_guard lock{ mutex_ };
+	const uint32_t index = allocateIndex(ResourceKind::StorageBuffer);
+	pendingWrites_.push_back(PendingWrite{
+		.kind = ResourceKind::StorageBuffer,
+		.index = index,
+		.imageInfo = {},
+		.bufferInfo = { .buffer = buffer, .offset = offset, .range = range },
+	});
+	return BufferHandle{ index };
+}
+
+void BindlessHeap::beginFrame(uint64_t frameNumber)
+{
+	std::lock_guard lock{ mutex_ };
+	frameNumber_ = frameNumber;
+	// ͷ֮־ framesInFlight ֡, ʹùѾִ
+	std::erase_if(retired_, [&](const RetiredIndex& retired) {
+		if (frameNumber < retired.retiredAtFrame + framesInFlight_) return false;
+		indices_[static_cast<uint32_t>(retired.kind)].freeIndices.push_back(retired.index);
+		return true;
+	});
+
+	if (pendingWrites_.empty()) return;
+	const auto writes = pendingWrites_ | std::views::transform([this](const PendingWrite& pending) {
+		constexpr std::array descriptorTypes{
+			VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+			VK_DESCRIPTOR_TYPE_SAMPLER,
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		};
+		const bool isBuffer = pending.kind == ResourceKind::StorageBuffer;
+		return VkWriteDescriptorSet{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = descriptorSet_,
+			.dstBinding = static_cast<uint32_t>(pending.kind),
+			.dstArrayElement = pending.index,
+			.descriptorCount = 1,
+			.descriptorType = descriptorTypes[static_cast<uint32_t>(pending.kind)],
+			.pImageInfo = isBuffer ? nullptr : &pending.imageInfo,
+			.pBufferInfo = isBuffer ? &pending.bufferInfo : nullptr,
+		};
+	}) | std::ranges::to<std::vector>();
+	vkUpdateDescriptorSets(device_, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	pendingWrites_.clear();
+}
+
+void BindlessHeap::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const
+{
+	vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout_, 0, 1, &descriptorSet_, 0, nullptr);
+}
+
+uint32_t BindlessHeap::allocateIndex(ResourceKind kind)
+{
+	auto& allocator = indices_[static_cast<uint32_t>(kind)];
+	if (!allocator.freeIndices.empty()) {
+		const uint32_t index = allocator.freeIndices.back();
+		allocator.freeIndices.pop_back();
+		return index;
+	}
+	const std::array limits{ capacity_.sampledImages, capacity_.samplers, capacity_.storageBuffers };
+	if (allocator.next >= limits[static_cast<uint32_t>(kind)]) {
+		throw std::runtime_error("bindless heap is full");
+	}
+	return allocator.next++;
+}
+
+void BindlessHeap::retire(ResourceKind kind, uint32_t index)
+{
+	std::lock_guard lock{ mutex_ };
+	// ûд descriptor ֱӶ
+	std::erase_if(pendingWrites_, [&](const PendingWrite& pending) { return pending.kind == kind && pending.index == index; });
+	retired_.push_back(RetiredIndex{ .kind = kind, .index = index, .retiredAtFrame = frameNumber_ });
+}
+
+/*
+ * render graph
+ *  pass дԴ, compile ʱһ:
+ * - ޳: ӵԴ (ͼ) , ûбõ pass ִ
+ * - barrier:  pass ˳ÿԴĲֺһη, ֻڲֱ仯ждͻʱ barrier,
+ *   ͬһ pass ֮ǰҪ barrier ϲΪһ vkCmdPipelineBarrier
+ * - ʱԴ (transient) ڴ渴:  (һεһʹõ pass) ,
+ *   ڲصͼ󶨵ͬһڴ, ߵĵһ barrier ȴǰһʹ߽, ɲΪ UNDEFINED
+ *    in flight ֡ͬһʱͼ, ÿڴϵһͼ barrier ȴһ֡ʹڴͼ
+ *   (pipeline barrier Խύ, ǰÿ֡ύͬһ)
+ * compile ĽֻͼĽṹ, ÿֻ֡Ҫ setImportedImage ϵ֡Ľͼ execute
+ *  attachment  pass  render graph ʼͽȾ:
+ * - 豸֧ʱʹ dynamic rendering (vkCmdBeginRendering), Ҫ VkRenderPass  VkFramebuffer, barrier ʹ synchronization2
+ * - ˻ 1.0 ķʽ: compile ʱΪÿ pass  VkRenderPass, framebuffer õ image view ڵһִʱ
+ * Դ pass Ҫ GpuProfiler ø (һΪ)
+ */
+class RenderGraph
+{
+public:
+	using ResourceId = uint32_t;
+	class PassContext;
+	using ExecuteFunction = std::function<void(VkCommandBuffer, const PassContext&)>;
+
+	// dynamic rendering  synchronization2 ĺ (1.3 Ļ KHR չ), ṩʱʹ VkRenderPass  vkCmdPipelineBarrier
+	struct DynamicRendering
+	{
+		PFN_vkCmdBeginRenderingKHR beginRendering;
+		PFN_vkCmdEndRenderingKHR endRendering;
+		PFN_vkCmdPipelineBarrier2KHR pipelineBarrier2;
+	};
+
+	// pass ͼķʷʽ, , stage, access Լʱͼ usage
+	enum class Access
+	{
+		TransferRead,
+		TransferWrite,
+		ColorAttachmentWrite,
+		DepthAttachmentWrite,
+		FragmentShaderRead,
+		ComputeShaderRead,
+		ComputeShaderWrite,
+	};
+
+	struct ImageDesc
+	{
+		VkFormat format;
+		VkExtent2D extent;
+	};
+
+	class PassBuilder
+	{
+	public:
+		void read(ResourceId resource, Access access) { add(resource, access, false); }
+		void write(ResourceId resource, Access access) { add(resource, access, true); }
+		// Ϊ attachment д, pass ִڼ䴦Ⱦ (render pass  dynamic rendering)
+		void colorAttachment(ResourceId resource, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_LOAD, VkClearValue clearValue = {});
+		void depthAttachment(ResourceId resource, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_LOAD, VkClearValue clearValue = {});
+		// Ⱦеȫ secondary command buffer ¼ (ͨ PassContext::inheritance ̳Ⱦ״̬)
+		void secondaryCommandBuffers();
+		// ͼ֮ĸ (дض), ᱻ޳
+		void sideEffect();
+
+	private:
+		friend class RenderGraph;
+		PassBuilder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+		RenderGraph& graph_;
+		uint32_t pass_;
+
+		void add(ResourceId resource, Access access, bool write);
+	};
+
+	// pass ִʱԷʵϢ
+	class PassContext
+	{
+	public:
+		PassContext(const PassContext& other) = delete;
+		PassContext(PassContext&& other) noexcept = delete;
+		PassContext& operator=(const PassContext& other) = delete;
+		PassContext& operator=(PassContext&& other) noexcept = delete;
+
+		[[nodiscard]] VkImage image(ResourceId resource) const { return graph_.image(resource); }
+		[[nodiscard]] VkImageView imageView(ResourceId resource) const { return graph_.imageView(resource); }
+		// Ⱦ,  attachment ĴС
+		[[nodiscard]] VkExtent2D renderArea() const { return renderArea_; }
+		// ¼ secondary command buffer ʱʹ, ǰ render pass  dynamic rendering ĸʽϢ
+		[[nodiscard]] const VkCommandBufferInheritanceInfo& inheritance() const { return inheritance_; }
+
+	private:
+		friend class RenderGraph;
+		PassContext(const RenderGraph& graph) : graph_(graph), renderArea_{}, colorFormats_{}, renderingInheritance_{}, inheritance_{} {}
+
+		const RenderGraph& graph_;
+		VkExtent2D renderArea_;
+		SmallVector<VkFormat, 8> colorFormats_;
+		VkCommandBufferInheritanceRenderingInfoKHR renderingInheritance_;
+		VkCommandBufferInheritanceInfo inheritance_;
+	};
+
+	struct Stats
+	{
+		uint32_t passCount;
+		uint32_t culledPassCount;
+		uint32_t barrierBatchCount;
+		uint32_t imageBarrierCount;
+		uint32_t transientImageCount;
+		// ʱͼʵռõڴ, С transientImageCount ˵˸
+		uint32_t memorySlotCount;
+		// ʱҪڴ, 븴úʵʷڴ
+		VkDeviceSize transientBytes;
+		VkDeviceSize allocatedBytes;
+	};
+
+	RenderGraph(VkDevice device, DeviceMemoryAllocator& allocator, std::optional<DynamicRendering> dynamicRendering);
+	~RenderGraph();
+
+	RenderGraph(const RenderGraph& other) = delete;
+	RenderGraph(RenderGraph&& other) noexcept = delete;
+	RenderGraph& operator=(const RenderGraph& other) = delete;
+	RenderGraph& operator=(RenderGraph&& other) noexcept = delete;
+
+	// ⲿͼ (罻ͼ), ִǰ setImportedImage ָ, ͼִת finalLayout
+	ResourceId importImage(std::string_view name, const ImageDesc& desc, VkImageLayout initialLayout, VkImageLayout finalLayout);
+	// ͼ͹ڴʱͼ, ÿ֡ʼʱδ
+	ResourceId createImage(std::string_view name, const ImageDesc& desc);
+	// setup дԴ, execute ִʱ¼
+	void addPass(std::string_view name, const std::function<void(PassBuilder&)>& setup, ExecuteFunction execute);
+
+	void compile();
+
+	// Ϊ attachment ʹõͼҪṩ image view
+	void setImportedImage(ResourceId resource, VkImage image, VkImageView imageView = VK_NULL_HANDLE)
+	{
+		resources_[resource].image = image;
+		resources_[resource].imageView = imageView;
+	}
+	[[nodiscard]] VkImage image(ResourceId resource) const { return resources_[resource].image; }
+	[[nodiscard]] VkImageView imageView(ResourceId resource) const { return resources_[resource].imageView; }
+	[[nodiscard]] bool dynamicRendering() const { return dynamicRendering_.has_value(); }
+	// ͼһαʹõ stage, Ϊȴ acquire semaphore  dstStageMask
+	[[nodiscard]] VkPipelineStageFlags firstStage(ResourceId resource) const { return resources_[resource].firstStage; }
+	[[nodiscard]] const Stats& stats() const { return stats_; }
+
+	// ÿ pass  profiler м¼һͬ scope, Ⱦе secondary command buffer ̳ profiler  pipeline statistics query
+	void execute(VkCommandBuffer commandBuffer, GpuProfiler& profiler) const;
+
+private:
+	static constexpr uint32_t noPass = std::numeric_limits<uint32_t>::max();
+	static constexpr ResourceId noResource = std::numeric_limits<ResourceId>::max();
+
+	struct AccessInfo
+	{
+		VkImageLayout layout;
+		VkPipelineStageFlags stage;
+		VkAccessFlags access;
+		VkImageUsageFlags usage;
+	};
+	static AccessInfo accessInfo(Access access);
+	static VkImageAspectFlags aspectOf(VkFormat format);
+
+	struct Resource
+	{
+		std::string_view name;
+		ImageDesc desc;
+		bool imported;
+		VkImageLayout initialLayout;
+		VkImageLayout finalLayout;
+		VkImage image;
+		VkImageView imageView;
+		VkImageUsageFlags usage;
+		//  pass еһκһʹ pass
+		uint32_t firstPass;
+		uint32_t lastPass;
+		VkPipelineStageFlags firstStage;
+		// ֮ǰռͬһڴʱͼ
+		ResourceId aliasedFrom;
+		// ÿڴϵĵһʱͼ: һ֡ռڴͼ (ûиʱΪԼ), Ϊ noResource
+		ResourceId previousFrameOccupant;
+	};
+
+	struct ResourceAccess
+	{
+		ResourceId resource;
+		Access access;
+		bool write;
+	};
+
+	struct ImageBarrier
+	{
+		ResourceId resource;
+		// synchronization2 ͼָ stage, ʹ stage
+		VkPipelineStageFlags srcStage;
+		VkPipelineStageFlags dstStage;
+		VkAccessFlags srcAccess;
+		VkAccessFlags dstAccess;
+		VkImageLayout oldLayout;
+		VkImageLayout newLayout;
+	};
+
+	struct BarrierBatch
+	{
+		VkPipelineStageFlags srcStage;
+		VkPipelineStageFlags dstStage;
+		std::vector<ImageBarrier> images;
+	};
+
+	struct Attachment
+	{
+		ResourceId resource;
+		VkAttachmentLoadOp loadOp;
+		VkClearValue clearValue;
+	};
+
+	struct Pass
+	{
+		std::string_view name;
+		std::vector<ResourceAccess> accesses;
+		ExecuteFunction execute;
+		bool sideEffect;
+		bool culled;
+		// ڸ pass ֮ǰִ
+		BarrierBatch barriers;
+
+		std::vector<Attachment> colorAttachments;
+		std::optional<Attachment> depthAttachment;
+		bool secondaryCommandBuffers;
+		// ֻڲ֧ dynamic rendering ʱʹ, framebuffer  attachment  image view Ϊ (ͼÿ֡ͬ)
+		VkRenderPass renderPass;
+		mutable std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers;
+
+		[[nodiscard]] bool rendering() const { return !colorAttachments.empty() || depthAttachment.has_value(); }
+	};
+
+	// һ鱻ڲصʱͼõڴ
+	struct MemorySlot
+	{
+		DeviceMemoryAllocator::Allocation allocation;
+		std::vector<ResourceId> resources;
+	};
+
+	VkDevice device_;
+	DeviceMemoryAllocator& allocator_;
+	std::optional<DynamicRendering> dynamicRendering_;
+	std::vector<Resource> resources_;
+	std::vector<Pass> passes_;
+	std::vector<MemorySlot> slots_;
+	//  pass ֮, ѵͼת finalLayout
+	BarrierBatch finalBarriers_;
+	Stats stats_;
+	bool compiled_;
+
+	void cullPasses();
+	void allocateTransientImages();
+	void computeBarriers();
+	void createRenderPasses();
+	void recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const;
+	// ʼȾд context еļ̳Ϣ
+	void beginRendering(VkCommandBuffer commandBuffer, const Pass& pass, PassContext& context) const;
+	void endRendering(VkCommandBuffer commandBuffer) const;
+	VkFramebuffer getFramebuffer(const Pass& pass, VkExtent2D extent) const;
+};
+
+void RenderGraph::PassBuilder::colorAttachment(ResourceId resource, VkAttachmentLoadOp loadOp, VkClearValue clearValue)
+{
+	add(resource, Access::ColorAttachmentWrite, true);
+	graph_.passes_[pass_].colorAttachments.push_back(Attachment{ .resource = resource, .loadOp = loadOp, .clearValue = clearValue });
+}
+
+void RenderGraph::PassBuilder::depthAttachment(ResourceId resource, VkAttachmentLoadOp loadOp, VkClearValue clearValue)
+{
+	add(resource, Access::DepthAttachmentWrite, true);
+	graph_.passes_[pass_].depthAttachment = Attachment{ .resource = resource, .loadOp = loadOp, .clearValue = clearValue };
+}
+
+void RenderGraph::PassBuilder::secondaryCommandBuffers()
+{
+	graph_.passes_[pass_].secondaryCommandBuffers = true;
+}
+
+void RenderGraph::PassBuilder::sideEffect()
+{
+	graph_.passes_[pass_].sideEffect = true;
+}
+
+void RenderGraph::PassBuilder::add(ResourceId resource, Access access, bool write)
+{
+	if (resource >= graph_.resources_.size()) {
+		throw std::runtime_error("render graph pass uses an unknown resource");
+	}
+	graph_.passes_[pass_].accesses.push_back(ResourceAccess{ .resource = resource, .access = access, .write = write });
+}
+
+RenderGraph::RenderGraph(VkDevice device, DeviceMemoryAllocator& allocator, std::optional<DynamicRendering> dynamicRendering)
+	: device_(device), allocator_(allocator), dynamicRendering_(dynamicRendering), finalBarriers_{}, stats_{}, compiled_(false)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	for (const auto& pass : passes_) {
+		for (const auto framebuffer : pass.framebuffers | std::views::values) {
+			vkDestroyFramebuffer(device_, framebuffer, nullptr);
+		}
+		vkDestroyRenderPass(device_, pass.renderPass, nullptr);
+	}
+	for (const auto& resource : resources_) {
+		if (!resource.imported) {
+			vkDestroyImageView(device_, resource.imageView, nullptr);
+			vkDestroyImage(device_, resource.image, nullptr);
+		}
+	}
+	for (auto& slot : slots_) {
+		allocator_.free(slot.allocation);
+	}
+}
+
+RenderGraph::ResourceId RenderGraph::importImage(std::string_view name, const ImageDesc& desc, VkImageLayout initialLayout, VkImageLayout finalLayout)
+{
+	resources_.push_back(Resource{
+		.name = name,
+		.desc = desc,
+		.imported = true,
+		.initialLayout = initialLayout,
+		.finalLayout = finalLayout,
+		.image = VK_NULL_HANDLE,
+		.imageView = VK_NULL_HANDLE,
+		.usage = 0,
+		.firstPass = noPass,
+		.lastPass = noPass,
+		.firstStage = 0,
+		.aliasedFrom = noResource,
+		.previousFrameOccupant = noResource,
+	});
+	return static_cast<ResourceId>(resources_.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::createImage(std::string_view name, const ImageDesc& desc)
+{
+	resources_.push_back(Resource{
+		.name = name,
+		.desc = desc,
+		.imported = false,
+		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		.image = VK_NULL_HANDLE,
+		.imageView = VK_NULL_HANDLE,
+		.usage = 0,
+		.firstPass = noPass,
+		.lastPass = noPass,
+		.firstStage = 0,
+		.aliasedFrom = noResource,
+		.previousFrameOccupant = noResource,
+	});
+	return static_cast<ResourceId>(resources_.size() - 1);
+}
+
+void RenderGraph::addPass(std::string_view name, const std::function<void(PassBuilder&)>& setup, ExecuteFunction execute)
+{
+	if (compiled_) {
+		throw std::runtime_error("render graph is already compiled");
+	}
+	passes_.push_back(Pass{
+		.name = name,
+		.accesses = {},
+		.execute = std::move(execute),
+		.sideEffect = false,
+		.culled = false,
+		.barriers = {},
+		.colorAttachments = {},
+		.depthAttachment = std::nullopt,
+		.secondaryCommandBuffers = false,
+		.renderPass = VK_NULL_HANDLE,
+		.framebuffers = {},
+	});
+	PassBuilder builder{ *this, static_cast<uint32_t>(passes_.size() - 1) };
+	setup(builder);
+}
+
+void RenderGraph::compile()
+{
+	if (compiled_) {
+		throw std::runtime_error("render graph is already compiled");
+	}
+	cullPasses();
+	allocateTransientImages();
+	computeBarriers();
+	if (!dynamicRendering_.has_value()) {
+		createRenderPasses();
+	}
+	compiled_ = true;
+
+	stats_.passCount = static_cast<uint32_t>(passes_.size());
+	stats_.culledPassCount = static_cast<uint32_t>(std::ranges::count_if(passes_, &Pass::culled));
+	stats_.barrierBatchCount = static_cast<uint32_t>(std::ranges::count_if(passes_, [](const Pass& pass) {
+		return !pass.culled && !pass.barriers.images.empty();
+	})) + (finalBarriers_.images.empty() ? 0 : 1);
+	stats_.imageBarrierCount = static_cast<uint32_t>(finalBarriers_.images.size());
+	for (const auto& pass : passes_) {
+		stats_.imageBarrierCount += static_cast<uint32_t>(pass.barriers.images.size());
+	}
+}
+
+void RenderGraph::cullPasses()
+{
+	// : д˺ҪԴ (ߵԴ)  pass Ҫ, ȡԴҲͱҪ
+	std::vector<bool> needed(resources_.size(), false);
+	for (const auto [index, resource] : resources_ | std::views::enumerate) {
+		needed[index] = resource.imported;
+	}
+	for (auto& pass : passes_ | std::views::reverse) {
+		const bool live = pass.sideEffect || std::ranges::any_of(pass.accesses, [&](const ResourceAccess& access) {
+			return access.write && needed[access.resource];
+		});
+		pass.culled = !live;
+		if (!live) continue;
+		for (const auto& access : pass.accesses) {
+			if (!access.write) needed[access.resource] = true;
+		}
+	}
+
+	for (const auto [index, pass] : passes_ | std::views::enumerate) {
+		if (pass.culled) continue;
+		for (const auto& access : pass.accesses) {
+			auto& resource = resources_[access.resource];
+			if (resource.firstPass == noPass) resource.firstPass = static_cast<uint32_t>(index);
+			resource.lastPass = static_cast<uint32_t>(index);
+			resource.usage |= accessInfo(access.access).usage;
+		}
+	}
+}
+
+void RenderGraph::allocateTransientImages()
+{
+	struct Candidate
+	{
+		ResourceId resource;
+		VkMemoryRequirements requirements;
+	};
+	std::vector<Candidate> candidates;
+	for (auto&& [index, resource] : resources_ | std::views::enumerate) {
+		// ûб pass ʹõʱͼ񲻴
+		if (resource.imported || resource.firstPass == noPass) continue;
+		const VkImageCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = resource.desc.format,
+			.extent = { resource.desc.extent.width, resource.desc.extent.height, 1 },
+			.mipLevels = 1,
+			.arrayLayers = 1,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = resource.usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		};
+		if (vkCreateImage(device_, &createInfo, nullptr, &resource.image) != VK_SUCCESS) {
+			throw std::runtime_error(std::format("failed to create render graph image {}", resource.name));
+		}
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(device_, resource.image, &requirements);
+		candidates.push_back(Candidate{ .resource = static_cast<ResourceId>(index), .requirements = requirements });
+		stats_.transientImageCount++;
+		stats_.transientBytes += requirements.size;
+	}
+
+	// ӴС, ÿڴĴСɵһ () ͼ, ֮ͼֻҪŵڲصɸ
+	std::ranges::sort(candidates, std::ranges::greater{}, [](const Candidate& candidate) { return candidate.requirements.size; });
+	for (const auto& [resourceId, requirements] : candidates) {
+		auto& resource = resources_[resourceId];
+		auto overlaps = [&](ResourceId other) {
+			const auto& occupant = resources_[other];
+			return resource.firstPass <= occupant.lastPass && occupant.firstPass <= resource.lastPass;
+		};
+		const auto slot = std::ranges::find_if(slots_, [&](const MemorySlot& slot) {
+			// buddy ƫС, С
+			// ڴʵڵ memory type, ͼ memoryTypeBits н
+			return slot.allocation.size >= requirements.size && slot.allocation.size >= requirements.alignment &&
+				(requirements.memoryTypeBits & (1u << slot.allocation.memoryTypeIndex)) != 0 &&
+				std::ranges::none_of(slot.resources, overlaps);
+		});
+
+		MemorySlot* pSlot;
+		if (slot != slots_.end()) {
+			pSlot = &*slot;
+		}
+		else {
+			pSlot = &slots_.emplace_back(MemorySlot{
+				.allocation = allocator_.allocate(requirements, DeviceMemoryAllocator::MemoryUsage::GpuOnly,
+					DeviceMemoryAllocator::ResourceKind::Optimal),
+				.resources = {},
+			});
+			stats_.allocatedBytes += pSlot->allocation.size;
+		}
+		pSlot->resources.push_back(resourceId);
+		if (vkBindImageMemory(device_, resource.image, pSlot->allocation.memory, pSlot->allocation.offset) != VK_SUCCESS) {
+			throw std::runtime_error(std::format("failed to bind render graph image {}", resource.name));
+		}
+		const VkImageViewCreateInfo viewCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = resource.image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = resource.desc.format,
+			.subresourceRange = { .aspectMask = aspectOf(resource.desc.format), .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1 },
+		};
+		if (vkCreateImageView(device_, &viewCreateInfo, nullptr, &resource.imageView) != VK_SUCCESS) {
+			throw std::runtime_error(std::format("failed to create render graph image view {}", resource.name));
+		}
+	}
+
+	// ͬһڴϵͼڻص, ʱÿͼȴǰһ
+	for (auto& slot : slots_) {
+		std::ranges::sort(slot.resources, {}, [this](ResourceId resource) { return resources_[resource].firstPass; });
+		for (const auto [previous, next] : slot.resources | std::views::pairwise) {
+			resources_[next].aliasedFrom = previous;
+		}
+		resources_[slot.resources.front()].previousFrameOccupant = slot.resources.back();
+	}
+	stats_.memorySlotCount = static_cast<uint32_t>(slots_.size());
+}
+
+void RenderGraph::computeBarriers()
+{
+	// ÿԴǰ״̬: , һηʵ stage  access (Ķϲһ), һηǷΪд
+	struct State
+	{
+		VkImageLayout layout;
+		VkPipelineStageFlags stage;
+		VkAccessFlags access;
+		bool written;
+		bool used;
+	};
+	std::vector<State> states(resources_.size());
+	for (const auto [index, resource] : resources_ | std::views::enumerate) {
+		states[index] = State{ .layout = resource.initialLayout, .stage = 0, .access = 0, .written = false, .used = false };
+	}
+	// ÿڴϵһͼ barrier (ڵ pass, barrier ±),  pass , ֪һ֡ʺд
+	std::vector<std::pair<Pass*, size_t>> frameBarriers;
+
+	for (auto& pass : passes_) {
+		if (pass.culled) continue;
+		for (const auto& [resourceId, access, write] : pass.accesses) {
+			auto& resource = resources_[resourceId];
+			auto& state = states[resourceId];
+			const auto info = accessInfo(access);
+
+			if (!state.used) {
+				state.used = true;
+				resource.firstStage = info.stage;
+				if (resource.aliasedFrom != noResource) {
+					// ȴǰһʹͬһڴͼ, ݲҪ
+					const auto& previous = states[resource.aliasedFrom];
+					state.stage = previous.stage;
+					state.access = previous.written ? previous.access : 0;
+					state.written = previous.written;
+				}
+				else if (resource.imported) {
+					// ͼ semaphore ȴ info.stage , barrier ֮ν
+					state.stage = info.stage;
+				}
+				else {
+					// һܻ֡ʹڴ, ֮һ֡滻
+					state.stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+					frameBarriers.emplace_back(&pass, pass.barriers.images.size());
+				}
+				// ʱͼÿ֡
+				if (!resource.imported) state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+				pass.barriers.srcStage |= state.stage;
+				pass.barriers.dstStage |= info.stage;
+				pass.barriers.images.push_back(ImageBarrier{
+					.resource = resourceId,
+					.srcStage = state.stage,
+					.dstStage = info.stage,
+					.srcAccess = state.access,
+					.dstAccess = info.access,
+					.oldLayout = state.layout,
+					.newLayout = info.layout,
+				});
+				state = State{ .layout = info.layout, .stage = info.stage, .access = info.access, .written = write, .used = true };
+				continue;
+			}
+
+			// ĶҲͬ: Ҫ barrier, ֮дҪȴеĶ
+			if (!write && !state.written && state.layout == info.layout) {
+				state.stage |= info.stage;
+				state.access |= info.access;
+				continue;
+			}
+			pass.barriers.srcStage |= state.stage;
+			pass.barriers.dstStage |= info.stage;
+			pass.barriers.images.push_back(ImageBarrier{
+				.resource = resourceId,
+				.srcStage = state.stage,
+				.dstStage = info.stage,
+				// ֮дֻҪִ
+				.srcAccess = state.written ? state.access : 0,
+				.dstAccess = info.access,
+				.oldLayout = state.layout,
+				.newLayout = info.layout,
+			});
+			state = State{ .layout = info.layout, .stage = info.stage, .access = info.access, .written = write, .used = true };
+		}
+	}
+
+	// ȴһ֡ռͬһڴͼһη: д֮дҪ access, ֮дֻҪִ
+	for (const auto [pPass, index] : frameBarriers) {
+		auto& barrier = pPass->barriers.images[index];
+		const auto& previous = states[resources_[barrier.resource].previousFrameOccupant];
+		barrier.srcStage = previous.stage;
+		barrier.srcAccess = previous.written ? previous.access : 0;
+		pPass->barriers.srcStage |= previous.stage;
+	}
+
+	for (const auto [index, resource] : resources_ | std::views::enumerate) {
+		const auto& state = states[index];
+		if (!resource.imported || !state.used || resource.finalLayout == state.layout) continue;
+		finalBarriers_.srcStage |= state.stage;
+		// present  semaphore ֤ɼ, Ҫ dstAccess
+		finalBarriers_.dstStage |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		finalBarriers_.images.push_back(ImageBarrier{
+			.resource = static_cast<ResourceId>(index),
+			.srcStage = state.stage,
+			.dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			.srcAccess = state.written ? state.access : 0,
+			.dstAccess = 0,
+			.oldLayout = state.layout,
+			.newLayout = resource.finalLayout,
+		});
+	}
+}
+
+void RenderGraph::createRenderPasses()
+{
+	for (auto& pass : passes_) {
+		if (pass.culled || !pass.rendering()) continue;
+
+		// ת render graph  barrier , render pass ڲı䲼, ҲҪ subpass dependency
+		std::vector<VkAttachmentDescription> descriptions;
+		std::vector<VkAttachmentReference> colorReferences;
+		auto describe = [&](const Attachment& attachment, VkImageLayout layout) {
+			descriptions.push_back(VkAttachmentDescription{
+				.format = resources_[attachment.resource].desc.format,
+				.samples = VK_SAMPLE_COUNT_1_BIT,
+				.loadOp = attachment.loadOp,
+				.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+				.stencilLoadOp = attachment.loadOp,
+				.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE,
+				.initialLayout = layout,
+				.finalLayout = layout,
+			});
+			return VkAttachmentReference{ .attachment = static_cast<uint32_t>(descriptions.size() - 1), .layout = layout };
+		};
+		for (const auto& attachment : pass.colorAttachments) {
+			colorReferences.push_back(describe(attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+		}
+		std::optional<VkAttachmentReference> depthReference;
+		if (pass.depthAttachment.has_value()) {
+			depthReference = describe(*pass.depthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+		}
+
+		const VkSubpassDescription subpass{
+			.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+			.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size()),
+			.pColorAttachments = colorReferences.data(),
+			.pDepthStencilAttachment = depthReference.has_value() ? &*depthReference : nullptr,
+		};
+		const VkRenderPassCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.attachmentCount = static_cast<uint32_t>(descriptions.size()),
+			.pAttachments = descriptions.data(),
+			.subpassCount = 1,
+			.pSubpasses = &subpass,
+		};
+		if (vkCreateRenderPass(device_, &createInfo, nullptr, &pass.renderPass) != VK_SUCCESS) {
+			throw std::runtime_error(std::format("failed to create render pass for {}", pass.name));
+		}
+	}
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer, GpuProfiler& profiler) const
+{
+	if (!compiled_) {
+		throw std::runtime_error("render graph is not compiled");
+	}
+	for (const auto& pass : passes_) {
+		if (pass.culled) continue;
+		recordBarriers(commandBuffer, pass.barriers);
+		const auto scope = profiler.scope(commandBuffer, pass.name);
+		PassContext context{ *this };
+		context.inheritance_ = VkCommandBufferInheritanceInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.renderPass = VK_NULL_HANDLE,
+			.subpass = 0,
+			.framebuffer = VK_NULL_HANDLE,
+			.occlusionQueryEnable = VK_FALSE,
+			// frame pass  pipeline statistics query ִ secondary ʱȻǻ, Ҫ̳
+			.pipelineStatistics = profiler.pipelineStatisticsEnabled() ? GpuProfiler::statisticFlags : 0,
+		};
+		if (pass.rendering()) {
+			beginRendering(commandBuffer, pass, context);
+			pass.execute(commandBuffer, context);
+			endRendering(commandBuffer);
+		}
+		else {
+			pass.execute(commandBuffer, context);
+		}
+	}
+	recordBarriers(commandBuffer, finalBarriers_);
+}
+
+void RenderGraph::beginRendering(VkCommandBuffer commandBuffer, const Pass& pass, PassContext& context) const
+{
+	const ResourceId first = !pass.colorAttachments.empty() ? pass.colorAttachments.front().resource : pass.depthAttachment->resource;
+	const VkExtent2D extent = resources_[first].desc.extent;
+	context.renderArea_ = extent;
+	const VkRect2D renderArea{ .offset = { 0, 0 }, .extent = extent };
+
+	if (dynamicRendering_.has_value()) {
+		auto attachmentInfo = [this](const Attachment& attachment, VkImageLayout layout) {
+			return VkRenderingAttachmentInfoKHR{
+				.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
+				.imageView = resources_[attachment.resource].imageView,
+				.imageLayout = layout,
+				.resolveMode = VK_RESOLVE_MODE_NONE,
+				.loadOp = attachment.loadOp,
+				.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+				.clearValue = attachment.clearValue,
+			};
+		};
+		SmallVector<VkRenderingAttachmentInfoKHR, 8> colorAttachments;
+		for (const auto& attachment : pass.colorAttachments) {
+			colorAttachments.push_back(attachmentInfo(attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+			context.colorFormats_.push_back(resources_[attachment.resource].desc.format);
+		}
+		std::optional<VkRenderingAttachmentInfoKHR> depthAttachment;
+		if (pass.depthAttachment.has_value()) {
+			depthAttachment = attachmentInfo(*pass.depthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+		}
+		const VkRenderingFlagsKHR flags = pass.secondaryCommandBuffers ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+		const VkRenderingInfoKHR renderingInfo{
+			.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+			.flags = flags,
+			.renderArea = renderArea,
+			.layerCount = 1,
+			.viewMask = 0,
+			.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size()),
+			.pColorAttachments = colorAttachments.data(),
+			.pDepthAttachment = depthAttachment.has_value() ? &*depthAttachment : nullptr,
+		};
+		dynamicRendering_->beginRendering(commandBuffer, &renderingInfo);
+
+		// secondary ͨ VkCommandBufferInheritanceRenderingInfo ̳ attachment ĸʽ
+		context.renderingInheritance_ = VkCommandBufferInheritanceRenderingInfoKHR{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+			.flags = flags,
+			.viewMask = 0,
+			.colorAttachmentCount = static_cast<uint32_t>(context.colorFormats_.size()),
+			.pColorAttachmentFormats = context.colorFormats_.data(),
+			.depthAttachmentFormat = pass.depthAttachment.has_value() ? resources_[pass.depthAttachment->resource].desc.format : VK_FORMAT_UNDEFINED,
+			.stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+		};
+		context.inheritance_.pNext = &context.renderingInheritance_;
+		return;
+	}
+
+	const VkFramebuffer framebuffer = getFramebuffer(pass, extent);
+	SmallVector<VkClearValue, 9> clearValues;
+	for (const auto& attachment : pass.colorAttachments) {
+		clearValues.push_back(attachment.clearValue);
+	}
+	if (pass.depthAttachment.has_value()) {
+		clearValues.push_back(pass.depthAttachment->clearValue);
+	}
+	const VkRenderPassBeginInfo beginInfo{
+		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+		.renderPass = pass.renderPass,
+		.framebuffer = framebuffer,
+		.renderArea = renderArea,
+		.clearValueCount = static_cast<uint32_t>(clearValues.size()),
+		.pClearValues = clearValues.data(),
+	};
+	vkCmdBeginRenderPass(commandBuffer, &beginInfo,
+		pass.secondaryCommandBuffers ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+	context.inheritance_.renderPass = pass.renderPass;
+	context.inheritance_.subpass = 0;
+	context.inheritance_.framebuffer = framebuffer;
+}
+
+void RenderGraph::endRendering(VkCommandBuffer commandBuffer) const
+{
+	if (dynamicRendering_.has_value()) {
+		dynamicRendering_->endRendering(commandBuffer);
+	}
+	else {
+		vkCmdEndRenderPass(commandBuffer);
+	}
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(const Pass& pass, VkExtent2D extent) const
+{
+	std::vector<VkImageView> views;
+	for (const auto& attachment : pass.colorAttachments) {
+		views.push_back(resources_[attachment.resource].imageView);
+	}
+	if (pass.depthAttachment.has_value()) {
+		views.push_back(resources_[pass.depthAttachment->resource].imageView);
+	}
+	if (const auto it = pass.framebuffers.find(views); it != pass.framebuffers.end()) {
+		return it->second;
+	}
+
+	const VkFramebufferCreateInfo createInfo{
+		.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+		.renderPass = pass.renderPass,
+		.attachmentCount = static_cast<uint32_t>(views.size()),
+		.pAttachments = views.data(),
+		.width = extent.width,
+		.height = extent.height,
+		.layers = 1,
+	};
+	VkFramebuffer framebuffer;
+	if (vkCreateFramebuffer(device_, &createInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+		throw std::runtime_error(std::format("failed to create framebuffer for {}", pass.name));
+	}
+	pass.framebuffers.emplace(std::move(views), framebuffer);
+	return framebuffer;
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const
+{
+	if (batch.images.empty()) return;
+	auto subresourceRange = [this](const ImageBarrier& barrier) {
+		return VkImageSubresourceRange{
+			.aspectMask = aspectOf(resources_[barrier.resource].desc.format),
+			.baseMipLevel = 0,
+			.levelCount = 1,
+			.baseArrayLayer = 0,
+			.layerCount = 1,
+		};
+	};
+
+	if (dynamicRendering_.has_value()) {
+		// synchronization2: ÿͼֻȴԼ stage, ΪϲķΧ
+		SmallVector<VkImageMemoryBarrier2KHR, 16> barriers;
+		for (const auto& barrier : batch.images) {
+			barriers.push_back(VkImageMemoryBarrier2KHR{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+				.srcStageMask = barrier.srcStage,
+				.srcAccessMask = barrier.srcAccess,
+				.dstStageMask = barrier.dstStage,
+				.dstAccessMask = barrier.dstAccess,
+				.oldLayout = barrier.oldLayout,
+				.newLayout = barrier.newLayout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = resources_[barrier.resource].image,
+				.subresourceRange = subresourceRange(barrier),
+			});
+		}
+		const VkDependencyInfoKHR dependencyInfo{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+			.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()),
+			.pImageMemoryBarriers = barriers.data(),
+		};
+		dynamicRendering_->pipelineBarrier2(commandBuffer, &dependencyInfo);
+		return;
+	}
+
+	SmallVector<VkImageMemoryBarrier, 16> barriers;
+	for (const auto& barrier : batch.images) {
+		barriers.push_back(VkImageMemoryBarrier{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = barrier.srcAccess,
+			.dstAccessMask = barrier.dstAccess,
+			.oldLayout = barrier.oldLayout,
+			.newLayout = barrier.newLayout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = resources_[barrier.resource].image,
+			.subresourceRange = subresourceRange(barrier),
+		});
+	}
+	vkCmdPipelineBarrier(commandBuffer, batch.srcStage, batch.dstStage, 0,
+		0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+RenderGraph::AccessInfo RenderGraph::accessInfo(Access access)
+{
+	switch (access) {
+	case Access::TransferRead:
+		return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+	case Access::TransferWrite:
+		return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+	case Access::ColorAttachmentWrite:
+		return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+	case Access::DepthAttachmentWrite:
+		return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT };
+	case Access::FragmentShaderRead:
+		return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT };
+	case Access::ComputeShaderRead:
+		return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT };
+	case Access::ComputeShaderWrite:
+		return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT };
+	}
+	throw std::runtime_error("unknown render graph access");
+}
+
+VkImageAspectFlags RenderGraph::aspectOf(VkFormat format)
+{
+	switch (format) {
+	case VK_FORMAT_D16_UNORM:
+	case VK_FORMAT_X8_D24_UNORM_PACK32:
+	case VK_FORMAT_D32_SFLOAT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT;
+	case VK_FORMAT_D16_UNORM_S8_UINT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	case VK_FORMAT_S8_UINT:
+		return VK_IMAGE_ASPECT_STENCIL_BIT;
+	default:
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+}
+
+/*
+ * һ VkQueue 
+ * VkQueue ϵ vkQueueSubmit / vkQueuePresentKHR Ҫⲿͬ, ÿиһ, ͬϵύȴ
+ */
+class SubmitQueue
+{
+public:
+	SubmitQueue(VkQueue queue, uint32_t family, float priority) : queue_(queue), family_(family), priority_(priority) {}
+
+	SubmitQueue(const SubmitQueue& other) = delete;
+	SubmitQueue(SubmitQueue&& other) noexcept = delete;
+	SubmitQueue& operator=(const SubmitQueue& other) = delete;
+	SubmitQueue& operator=(SubmitQueue&& other) noexcept = delete;
+
+	// ̰߳ȫ
+	VkResult submit(std::span<const VkSubmitInfo> submits, VkFence fence = VK_NULL_HANDLE);
+	VkResult present(const VkPresentInfoKHR& presentInfo);
+	// ߳ʹʱȴ, ؿ
+	std::optional<VkResult> trySubmit(std::span<const VkSubmitInfo> submits, VkFence fence = VK_NULL_HANDLE);
+
+	// ֱʹþʱҪԼ֤û߳ͬʱύ (ʱ)
+	[[nodiscard]] VkQueue handle() const { return queue_; }
+	[[nodiscard]] uint32_t family() const { return family_; }
+	[[nodiscard]] float priority() const { return priority_; }
+
+private:
+	VkQueue queue_;
+	uint32_t family_;
+	float priority_;
+	std::mutex mutex_;
+};
+
+VkResult SubmitQueue::submit(std::span<const VkSubmitInfo> submits, VkFence fence)
+{
+	std::lock_guard lock(mutex_);
+	return vkQueueSubmit(queue_, static_cast<uint32_t>(submits.size()), submits.data(), fence);
+}
+
+VkResult SubmitQueue::present(const VkPresentInfoKHR& presentInfo)
+{
+	std::lock_guard lock(mutex_);
+	return vkQueuePresentKHR(queue_, &presentInfo);
+}
+
+std::optional<VkResult> SubmitQueue::trySubmit(std::span<const VkSubmitInfo> submits, VkFence fence)
+{
+	std::unique_lock lock(mutex_, std::try_to_lock);
+	if (!lock.owns_lock()) return std::nullopt;
+	return vkQueueSubmit(queue_, static_cast<uint32_t>(submits.size()), submits.data(), fence);
+}
+
+/*
+ * 
+ * ÿɫԼĶɸ, ÿдȼ (0.0  1.0, ֻӰͬһڶ֮ĵ)
+ * - ͬһ󰴽ɫ˳η, еĶвʱ, ˳ѾĶ (ͬһ)
+ * -  0 бʾøöѾĵһ, ûʱһ ( present  render )
+ * - submit ûȫ: ӵ̶̹߳Ķпʼ try_lock, ͬһɫжʱ̵ͬ߳ύһ㲻ụȴ
+ */
+class QueueTopology
+{
+public:
+	enum class Role : uint32_t
+	{
+		// ÿ֡Ⱦ, ȼ
+		Render,
+		Present,
+		// Դϴ, ȼ
+		Streaming,
+		// 첽ͺ̨
+		Compute,
+	};
+	static constexpr size_t roleCount = 4;
+
+	struct RoleRequest
+	{
+		uint32_t family;
+		uint32_t count;
+		float priority;
+	};
+
+	// families Ϊ, ÿĶ queueCount
+	QueueTopology(const std::array<RoleRequest, roleCount>& requests, std::span<const VkQueueFamilyProperties> families);
+
+	QueueTopology(const QueueTopology& other) = delete;
+	QueueTopology(QueueTopology&& other) noexcept = delete;
+	QueueTopology& operator=(const QueueTopology& other) = delete;
+	QueueTopology& operator=(QueueTopology&& other) noexcept = delete;
+
+	//  VkDeviceCreateInfo, ָڲ
+	[[nodiscard]] std::span<const VkDeviceQueueCreateInfo> createInfos() const { return createInfos_; }
+	//  device ֮, ȡж
+	void resolve(VkDevice device);
+
+	[[nodiscard]] SubmitQueue& queue(Role role, uint32_t index = 0) { return *queues_[roleSlots_[static_cast<size_t>(role)][index]]; }
+	[[nodiscard]] uint32_t queueCount(Role role) const { return static_cast<uint32_t>(roleSlots_[static_cast<size_t>(role)].size()); }
+	[[nodiscard]] uint32_t family(Role role) const { return families_[static_cast<size_t>(role)]; }
+	// ɫǷʹͬһ
+	[[nodiscard]] bool shared(Role a, uint32_t indexA, Role b, uint32_t indexB) const;
+	// ʵʴĶ
+	[[nodiscard]] uint32_t totalQueueCount() const { return static_cast<uint32_t>(slots_.size()); }
+
+	// ̰߳ȫ, ύýɫһ
+	VkResult submit(Role role, std::span<const VkSubmitInfo> submits, VkFence fence = VK_NULL_HANDLE);
+
+private:
+	struct Slot
+	{
+		uint32_t family;
+		uint32_t index;
+		float priority;
+	};
+	std::vector<Slot> slots_;
+	// ɫʹõ slots_ ±
+	std::array<std::vector<uint32_t>, roleCount> roleSlots_;
+	std::array<uint32_t, roleCount> families_;
+	//  -> öиеȼ, createInfos_ ָе
+	std::map<uint32_t, std::vector<float>> priorities_;
+	std::vector<VkDeviceQueueCreateInfo> createInfos_;
+	//  slots_ һһӦ, resolve ֮
+	std::vector<std::unique_ptr<SubmitQueue>> queues_;
+};
+
+QueueTopology::QueueTopology(const std::array<RoleRequest, roleCount>& requests, std::span<const VkQueueFamilyProperties> families)
+{
+	//  -> öѾ slot
+	std::map<uint32_t, std::vector<uint32_t>> familySlots;
+	for (const auto [role, request] : requests | std::views::enumerate) {
+		families_[role] = request.family;
+		auto& allocated = familySlots[request.family];
+		auto& used = roleSlots_[role];
+		if (request.count == 0 && !allocated.empty()) {
+			used.push_back(allocated.front());
+			continue;
+		}
+		const uint32_t available = families[request.family].queueCount;
+		// ýɫڹʱ, ʹõĽɫɢͬĶ
+		const size_t shareBegin = allocated.size();
+		for (uint32_t i = 0; i < std::max(request.count, 1u); i++) {
+			if (allocated.size() < available) {
+				const auto slot = static_cast<uint32_t>(slots_.size());
+				slots_.push_back(Slot{ request.family, static_cast<uint32_t>(allocated.size()), request.priority });
+				allocated.push_back(slot);
+				used.push_back(slot);
+			}
+			else {
+				used.push_back(allocated[(shareBegin + i) % allocated.size()]);
+			}
+		}
+		// ͬһֻ¼һ
+		std::ranges::sort(used);
+		used.erase(std::ranges::unique(used).begin(), used.end());
+	}
+
+	for (const auto& slot : slots_) {
+		priorities_[slot.family].push_back(slot.priority);
+	}
+	for (const auto& [family, priorities] : priorities_) {
+		createInfos_.push_back(VkDeviceQueueCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.queueFamilyIndex = family,
+			.queueCount = static_cast<uint32_t>(priorities.size()),
+			.pQueuePriorities = priorities.data(),
+		});
+	}
+}
+
+void QueueTopology::resolve(VkDevice device)
+{
+	queues_.clear();
+	for (const auto& slot : slots_) {
+		VkQueue queue;
+		vkGetDeviceQueue(device, slot.family, slot.index, &queue);
+		queues_.push_back(std::make_unique<SubmitQueue>(queue, slot.family, slot.priority));
+	}
+}
+
+bool QueueTopology::shared(Role a, uint32_t indexA, Role b, uint32_t indexB) const
+{
+	return roleSlots_[static_cast<size_t>(a)][indexA] == roleSlots_[static_cast<size_t>(b)][indexB];
+}
+
+VkResult QueueTopology::submit(Role role, std::span<const VkSubmitInfo> submits, VkFence fence)
+{
+	const auto& used = roleSlots_[static_cast<size_t>(role)];
+	// job system ̰߳Ź̶ͬĶ (߳Ϊ 0), ̰߳ id Ĺϣ
+	const uint32_t threadIndex = JobSystem::currentThreadIndex();
+	const size_t home = (threadIndex != JobSystem::invalidThreadIndex ?
+		threadIndex : std::hash<std::thread::id>{}(std::this_thread::get_id())) % used.size();
+	for (size_t i = 0; i < used.size(); i++) {
+		if (const auto result = queues_[used[(home + i) % used.size()]]->trySubmit(submits, fence)) {
+			return *result;
+		}
+	}
+	return queues_[used[home]]->submit(submits, fence);
+}
+
+// timeline semaphore ĺ (1.2 Ļ KHR չ)
+struct TimelineSemaphoreFunctions
+{
+	PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue;
+	PFN_vkWaitSemaphoresKHR waitSemaphores;
+	PFN_vkSignalSemaphoreKHR signalSemaphore;
+};
+
+/*
+ * 첽ϴ
+ * ύ transfer  (רõ transfer ʱȾ),  timeline semaphore 
+ * - дһפ map  staging λ, submit ʱŶӵÿֽ֡ԤںϲΪһύ
+ *   ͬһĿĶϲΪһ vkCmdCopyBuffer / vkCmdCopyBufferToImage
+ * - ĿԴɵߴ (EXCLUSIVE), transfer  graphics ΪͬʱҪתȨ:
+ *   transfer  release, ɺ graphics ֡Ŀͷ acquire (ʱ semaphore Ѿ signal, ȴ)
+ * - ÿ󷵻һ token, ready(token) ֮¼ƵʹøԴ
+ * upload* ̵߳, acquire  submit ̵ֻ߳
+ */
+class UploadEngine
+{
+public:
+	// ,  1 ʼ
+	using Token = uint64_t;
+
+	struct Config
+	{
+		SubmitQueue* transferQueue;
+		uint32_t transferFamily;
+		uint32_t graphicsFamily;
+		VkDeviceSize stagingSize;
+		// ÿ submit ύֽ (һ), һ֡ڵĴϴռ
+		VkDeviceSize frameBudget;
+	};
+
+	struct Stats
+	{
+		uint64_t requestCount;
+		uint64_t batchCount;
+		uint64_t uploadedBytes;
+		// Ϊ staging Ƴٵ֮֡Ĵ
+		uint64_t stagingStalls;
+	};
+
+	UploadEngine(VkDevice device, DeviceMemoryAllocator& allocator, const TimelineSemaphoreFunctions& timeline, const Config& config);
+	~UploadEngine();
+
+	UploadEngine(const UploadEngine& other) = delete;
+	UploadEngine(UploadEngine&& other) noexcept = delete;
+	UploadEngine& operator=(const UploadEngine& other) = delete;
+	UploadEngine& operator=(UploadEngine&& other) noexcept = delete;
+
+	// Ŀ buffer Ҫ TRANSFER_DST usage, data Ϊ
+	Token uploadBuffer(VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> data);
+	// д image һ subresource (extent Ϊ mip ĴС), ԭݲ, ɺ󲼾Ϊ finalLayout
+	// ûר transfer е豸 minImageTransferGranularity Ҫ mip, Բֲ֧
+	Token uploadImage(VkImage image, const VkImageSubresourceLayers& subresource, VkExtent3D extent,
+		VkImageLayout finalLayout, std::span<const std::byte> data);
+
+	// Ѿɵ, ǵ acquire barrier ¼Ƶ graphics е command buffer 
+	// ظ command buffer ύʱҪ semaphore() ϵȴֵ, 0 ʾҪȴ
+	uint64_t acquire(VkCommandBuffer commandBuffer);
+	// ԤύŶӵ
+	void submit();
+
+	[[nodiscard]] bool ready(Token token) const { return token <= readyToken_.load(std::memory_order_acquire); }
+	[[nodiscard]] VkSemaphore semaphore() const { return semaphore_; }
+	[[nodiscard]] bool ownershipTransfer() const { return config_.transferFamily != config_.graphicsFamily; }
+	[[nodiscard]] Stats stats() const;
+
+private:
+	//  vkCmdCopyBufferToImage  bufferOffset Ҫ (4  texel Сı)
+	static constexpr VkDeviceSize stagingAlignment = 16;
+
+	struct Request
+	{
+		Token token;
+		// buffer ʱ image Ϊ
+		VkBuffer buffer;
+		VkDeviceSize bufferOffset;
+		VkImage image;
+		VkImageSubresourceLayers subresource;
+		VkExtent3D extent;
+		VkImageLayout finalLayout;
+		VkDeviceSize size;
+		// Ѿд staging ʱΪڻλеλ, ݴ data 
+		std::optional<VkDeviceSize> stagingPosition;
+		std::vector<std::byte> data;
+	};
+
+	struct Batch
+	{
+		uint64_t timelineValue;
+		Token lastToken;
+		VkDeviceSize stagingEnd;
+		VkCommandBuffer commandBuffer;
+		std::vector<VkBufferMemoryBarrier> bufferAcquires;
+		std::vector<VkImageMemoryBarrier> imageAcquires;
+	};
+
+	VkDevice device_;
+	DeviceMemoryAllocator& allocator_;
+	TimelineSemaphoreFunctions timeline_;
+	Config config_;
+	VkBuffer stagingBuffer_;
+	DeviceMemoryAllocator::Allocation stagingAllocation_;
+	VkSemaphore semaphore_;
+	VkCommandPool commandPool_;
+	std::vector<VkCommandBuffer> freeCommandBuffers_;
+
+	mutable std::mutex mutex_;
+	// staging ʹõĲΪ [stagingTail_, stagingHead_), λõ,  stagingSize ȡģõƫ
+	VkDeviceSize stagingHead_;
+	VkDeviceSize stagingTail_;
+	std::deque<Request> pending_;
+	std::deque<Batch> inFlight_;
+	Token nextToken_;
+	uint64_t timelineValue_;
+	std::atomic<Token> readyToken_;
+	Stats stats_;
+
+	Token enqueue(Request request, std::span<const std::byte> data);
+	std::optional<VkDeviceSize> allocateStaging(VkDeviceSize size);
+	void record(VkCommandBuffer commandBuffer, std::span<const Request> requests, Batch& batch) const;
+};
+
+UploadEngine::UploadEngine(VkDevice device, DeviceMemoryAllocator& allocator, const TimelineSemaphoreFunctions& timeline, const Config& config)
+	: device_(device), allocator_(allocator), timeline_(timeline), config_(config), stagingBuffer_(VK_NULL_HANDLE), stagingAllocation_{},
+	semaphore_(VK_NULL_HANDLE), commandPool_(VK_NULL_HANDLE), stagingHead_(0), stagingTail_(0), nextToken_(1), timelineValue_(0),
+	readyToken_(0), stats_{}
+{
+	// λÿһȦӶλÿʼ
+	config_.stagingSize = (config_.stagingSize + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+
+	const VkBufferCreateInfo bufferCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size = config_.stagingSize,
+		.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+	};
+	if (vkCreateBuffer(device_, &bufferCreateInfo, nullptr, &stagingBuffer_) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create upload staging buffer");
+	}
+	stagingAllocation_ = allocator_.allocateForBuffer(stagingBuffer_, DeviceMemoryAllocator::MemoryUsage::Upload);
+
+	const VkSemaphoreTypeCreateInfoKHR typeCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+		.initialValue = 0,
+	};
+	const VkSemaphoreCreateInfo semaphoreCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &typeCreateInfo,
+	};
+	if (vkCreateSemaphore(device_, &semaphoreCreateInfo, nullptr, &semaphore_) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create upload timeline semaphore");
+	}
+
+	const VkCommandPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		// command buffer ɺ󵥶
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+		.queueFamilyIndex = config_.transferFamily,
+	};
+	if (vkCreateCommandPool(device_, &poolCreateInfo, nullptr, &commandPool_) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create upload command pool");
+	}
+}
+
+UploadEngine::~UploadEngine()
+{
+	// ȴѾύĿ, ֮ staging
+	if (timelineValue_ > 0) {
+		const VkSemaphoreWaitInfoKHR waitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+			.semaphoreCount = 1,
+			.pSemaphores = &semaphore_,
+			.pValues = &timelineValue_,
+		};
+		timeline_.waitSemaphores(device_, &waitInfo, std::numeric_limits<uint64_t>::max());
+	}
+	vkDestroyCommandPool(device_, commandPool_, nullptr);
+	vkDestroySemaphore(device_, semaphore_, nullptr);
+	vkDestroyBuffer(device_, stagingBuffer_, nullptr);
+	allocator_.free(stagingAllocation_);
+}
+
+UploadEngine::Token UploadEngine::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> data)
+{
+	return enqueue(Request{
+		.token = 0,
+		.buffer = buffer,
+		.bufferOffset = offset,
+		.image = VK_NULL_HANDLE,
+		.subresource = {},
+		.extent = {},
+		.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		.size = data.size(),
+		.stagingPosition = std::nullopt,
+		.data = {},
+	}, data);
+}
+
+UploadEngine::Token UploadEngine::uploadImage(VkImage image, const VkImageSubresourceLayers& subresource, VkExtent3D extent,
+	VkImageLayout finalLayout, std::span<const std::byte> data)
+{
+	return enqueue(Request{
+		.token = 0,
+		.buffer = VK_NULL_HANDLE,
+		.bufferOffset = 0,
+		.image = image,
+		.subresource = subresource,
+		.extent = extent,
+		.finalLayout = finalLayout,
+		.size = data.size(),
+		.stagingPosition = std::nullopt,
+		.data = {},
+	}, data);
+}
+
+UploadEngine::Token UploadEngine::enqueue(Request request, std::span<const std::byte> data)
+{
+	// СΪ 0  copy  barrier Ч÷
+	if (data.empty()) {
+		throw std::runtime_error("upload of 0 bytes");
+	}
+	if (data.size() > config_.stagingSize) {
+		throw std::runtime_error(std::format("upload of {} bytes is larger than the staging ring ({} bytes)", data.size(), config_.stagingSize));
+	}
+	std::lock_guard lock(mutex_);
+	request.token = nextToken_++;
+	// staging ˳ύ˳һ (ʱ˳), ǰ滹ûдʱֻݴ
+	if (pending_.empty() || pending_.back().stagingPosition.has_value()) {
+		request.stagingPosition = allocateStaging(data.size());
+	}
+	if (request.stagingPosition.has_value()) {
+		std::memcpy(static_cast<std::byte*>(stagingAllocation_.mapped) + *request.stagingPosition % config_.stagingSize,
+			data.data(), data.size());
+	}
+	else {
+		request.data.assign(data.begin(), data.end());
+	}
+	stats_.requestCount++;
+	pending_.push_back(std::move(request));
+	return pending_.back().token;
+}
+
+std::optional<VkDeviceSize> UploadEngine::allocateStaging(VkDeviceSize size)
+{
+	const VkDeviceSize ringSize = config_.stagingSize;
+	VkDeviceSize position = (stagingHead_ + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+	// һݱ, ŲʱһȦĿͷ
+	if (position % ringSize + size > ringSize) {
+		position = (position + ringSize - 1) / ringSize * ringSize;
+	}
+	if (position + size - stagingTail_ > ringSize) {
+		return std::nullopt;
+	}
+	stagingHead_ = position + size;
+	return position;
+}
+
+uint64_t UploadEngine::acquire(VkCommandBuffer commandBuffer)
+{
+	std::lock_guard lock(mutex_);
+	if (inFlight_.empty()) return 0;
+	uint64_t completed = 0;
+	if (timeline_.getSemaphoreCounterValue(device_, semaphore_, &completed) != VK_SUCCESS) {
+		throw std::runtime_error("failed to query upload timeline semaphore");
+	}
+
+	std::vector<VkBufferMemoryBarrier> bufferBarriers;
+	std::vector<VkImageMemoryBarrier> imageBarriers;
+	uint64_t waitValue = 0;
+	while (!inFlight_.empty() && inFlight_.front().timelineValue <= completed) {
+		auto& batch = inFlight_.front();
+		bufferBarriers.insert(bufferBarriers.end(), batch.bufferAcquires.begin(), batch.bufferAcquires.end());
+		imageBarriers.insert(imageBarriers.end(), batch.imageAcquires.begin(), batch.imageAcquires.end());
+		stagingTail_ = batch.stagingEnd;
+		freeCommandBuffers_.push_back(batch.commandBuffer);
+		readyToken_.store(batch.lastToken, std::memory_order_release);
+		waitValue = batch.timelineValue;
+		inFlight_.pop_front();
+	}
+	if (!bufferBarriers.empty() || !imageBarriers.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+			0, nullptr,
+			static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+			static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+	}
+	return waitValue;
+}
+
+void UploadEngine::submit()
+{
+	std::lock_guard lock(mutex_);
+	VkDeviceSize budget = config_.frameBudget;
+	size_t count = 0;
+	for (auto& request : pending_) {
+		if (count > 0 && request.size > budget) break;
+		if (!request.stagingPosition.has_value()) {
+			request.stagingPosition = allocateStaging(request.size);
+			if (!request.stagingPosition.has_value()) {
+				// ֮ǰ,  staging ֮ύ
+				stats_.stagingStalls++;
+				break;
+			}
+			std::memcpy(static_cast<std::byte*>(stagingAllocation_.mapped) + *request.stagingPosition % config_.stagingSize,
+				request.data.data(), request.data.size());
+			request.data = {};
+		}
+		budget -= std::min(budget, request.size);
+		count++;
+	}
+	if (count == 0) return;
+
+	const std::vector<Request> requests(std::make_move_iterator(pending_.begin()), std::make_move_iterator(pending_.begin() + count));
+	pending_.erase(pending_.begin(), pending_.begin() + count);
+
+	VkCommandBuffer commandBuffer;
+	if (!freeCommandBuffers_.empty()) {
+		commandBuffer = freeCommandBuffers_.back();
+		freeCommandBuffers_.pop_back();
+	}
+	else {
+		const VkCommandBufferAllocateInfo allocateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = commandPool_,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+		if (vkAllocateCommandBuffers(device_, &allocateInfo, &commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate upload command buffer");
+		}
+	}
+
+	const VkCommandBufferBeginInfo beginInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording upload command buffer");
+	}
+	Batch batch{
+		.timelineValue = timelineValue_ + 1,
+		.lastToken = requests.back().token,
+		.stagingEnd = *requests.back().stagingPosition + requests.back().size,
+		.commandBuffer = commandBuffer,
+		.bufferAcquires = {},
+		.imageAcquires = {},
+	};
+	record(commandBuffer, requests, batch);
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record upload command buffer");
+	}
+
+	const VkTimelineSemaphoreSubmitInfoKHR timelineInfo{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &batch.timelineValue,
+	};
+	const VkSubmitInfo submitInfo{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineInfo,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &commandBuffer,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &semaphore_,
+	};
+	if (config_.transferQueue->submit({ &submitInfo, 1 }) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit upload command buffer");
+	}
+	timelineValue_ = batch.timelineValue;
+	stats_.batchCount++;
+	stats_.uploadedBytes += std::ranges::fold_left(requests | std::views::transform(&Request::size), VkDeviceSize{ 0 }, std::plus{});
+	inFlight_.push_back(std::move(batch));
+}
+
+void UploadEngine::record(VkCommandBuffer commandBuffer, std::span<const Request> requests, Batch& batch) const
+{
+	// תȨʱ release barrier ֻ𲼾ת, ɼ semaphore ֤
+	const uint32_t srcFamily = ownershipTransfer() ? config_.transferFamily : VK_QUEUE_FAMILY_IGNORED;
+	const uint32_t dstFamily = ownershipTransfer() ? config_.graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+
+	std::vector<VkImageMemoryBarrier> toTransferDst;
+	std::vector<VkImageMemoryBarrier> imageReleases;
+	std::vector<VkBufferMemoryBarrier> bufferReleases;
+	std::map<VkBuffer, std::vector<VkBufferCopy>> bufferCopies;
+	std::map<VkImage, std::vector<VkBufferImageCopy>> imageCopies;
+	for (const auto& request : requests) {
+		const VkDeviceSize stagingOffset = *request.stagingPosition % config_.stagingSize;
+		if (request.image == VK_NULL_HANDLE) {
+			bufferCopies[request.buffer].push_back(VkBufferCopy{
+				.srcOffset = stagingOffset,
+				.dstOffset = request.bufferOffset,
+				.size = request.size,
+			});
+			if (!ownershipTransfer()) continue;
+			const VkBufferMemoryBarrier release{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+				.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+				.dstAccessMask = 0,
+				.srcQueueFamilyIndex = srcFamily,
+				.dstQueueFamilyIndex = dstFamily,
+				.buffer = request.buffer,
+				.offset = request.bufferOffset,
+				.size = request.size,
+			};
+			bufferReleases.push_back(release);
+			auto& acquire = batch.bufferAcquires.emplace_back(release);
+			acquire.srcAccessMask = 0;
+			acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			continue;
+		}
+
+		const VkImageSubresourceRange range{
+			.aspectMask = request.subresource.aspectMask,
+			.baseMipLevel = request.subresource.mipLevel,
+			.levelCount = 1,
+			.baseArrayLayer = request.subresource.baseArrayLayer,
+			.layerCount = request.subresource.layerCount,
+		};
+		toTransferDst.push_back(VkImageMemoryBarrier{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = request.image,
+			.subresourceRange = range,
+		});
+		imageCopies[request.image].push_back(VkBufferImageCopy{
+			.bufferOffset = stagingOffset,
+			.bufferRowLength = 0,
+			.bufferImageHeight = 0,
+			.imageSubresource = request.subresource,
+			.imageOffset = { 0, 0, 0 },
+			.imageExtent = request.extent,
+		});
+		const VkImageMemoryBarrier release{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = 0,
+			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.newLayout = request.finalLayout,
+			.srcQueueFamilyIndex = srcFamily,
+			.dstQueueFamilyIndex = dstFamily,
+			.image = request.image,
+			.subresourceRange = range,
+		};
+		imageReleases.push_back(release);
+		if (ownershipTransfer()) {
+			// acquire Ĳת release ͬ
+			auto& acquire = batch.imageAcquires.emplace_back(release);
+			acquire.srcAccessMask = 0;
+			acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		}
+	}
+
+	if (!toTransferDst.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, static_cast<uint32_t>(toTransferDst.size()), toTransferDst.data());
+	}
+	for (const auto& [buffer, regions] : bufferCopies) {
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer_, buffer, static_cast<uint32_t>(regions.size()), regions.data());
+	}
+	for (const auto& [image, regions] : imageCopies) {
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer_, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(regions.size()), regions.data());
+	}
+	if (!bufferReleases.empty() || !imageReleases.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+			0, nullptr,
+			static_cast<uint32_t>(bufferReleases.size()), bufferReleases.data(),
+			static_cast<uint32_t>(imageReleases.size()), imageReleases.data());
+	}
+}
+
+UploadEngine::Stats UploadEngine::stats() const
+{
+	std::lock_guard lock(mutex_);
+	return stats_;
+}
+
+/*
+ * 첽
+ * compute ύĶ (ʹò֧ graphics Ķ,  graphics еĵڶ), Ⱦִ
+ * ύ֮Լͼύ֮ȫʽ: ÿύ signal Լ timeline semaphore ϵһֵ (ticket),
+ * Ҫһȴ after(ticket),  compute ҲԵȴͼύ timeline semaphore
+ * ͼζйԴҪʹ VK_SHARING_MODE_CONCURRENT, ߵԼ¼Ȩת
+ * graphics ֻһʱ compute Ⱦͬһ VkQueue, аύ˳,
+ * ȴ֮ύͼ compute ס (֮ͼύҲ޷ִ), ʱܵȴδͼύ,
+ * Ⱦ compute Ҫֱ¼ͼ command buffer 
+ * ̵ֻ߳
+ */
+class AsyncCompute
+{
+public:
+	// ύʱ timeline semaphore ֵ,  1 ʼ
+	using Ticket = uint64_t;
+	using RecordFunction = std::function<void(VkCommandBuffer)>;
+
+	// ύ֮ǰҪ: semaphore ﵽ value ֮ stage ܿʼִ
+	struct Wait
+	{
+		VkSemaphore semaphore;
+		uint64_t value;
+		VkPipelineStageFlags stage;
+	};
+
+	// ύ queue , timeline semaphore ֵύ˳ signal
+	AsyncCompute(VkDevice device, const TimelineSemaphoreFunctions& timeline, SubmitQueue& queue, uint32_t framesInFlight);
+	~AsyncCompute();
+
+	AsyncCompute(const AsyncCompute& other) = delete;
+	AsyncCompute(AsyncCompute&& other) noexcept = delete;
+	AsyncCompute& operator=(const AsyncCompute& other) = delete;
+	AsyncCompute& operator=(AsyncCompute&& other) noexcept = delete;
+
+	// ÿ֡, ø֡λ command pool (ȴ framesInFlight ֮֡ǰڸòλύ compute )
+	void beginFrame(uint32_t frameIndex);
+	// ¼Ʋύһ primary command buffer,  waits ִ֮
+	Ticket submit(const RecordFunction& record, std::span<const Wait> waits = {});
+
+	// ȴ ticket Ӧύ
+	[[nodiscard]] Wait after(Ticket ticket, VkPipelineStageFlags stage) const { return Wait{ semaphore_, ticket, stage }; }
+	[[nodiscard]] bool completed(Ticket ticket) const;
+	void wait(Ticket ticket) const;
+
+	[[nodiscard]] uint32_t queueFamily() const { return queue_.family(); }
+	[[nodiscard]] uint64_t submitCount() const { return lastTicket_; }
+
+private:
+	struct FramePool
+	{
+		VkCommandPool commandPool;
+		std::vector<VkCommandBuffer> commandBuffers;
+		uint32_t used;
+		// òλһύ ticket,  command pool ǰȴ
+		Ticket lastTicket;
+	};
+
+	VkDevice device_;
+	TimelineSemaphoreFunctions timeline_;
+	SubmitQueue& queue_;
+	VkSemaphore semaphore_;
+	std::vector<FramePool> pools_;
+	uint32_t currentFrame_;
+	Ticket lastTicket_;
+};
+
+AsyncCompute::AsyncCompute(VkDevice device, const TimelineSemaphoreFunctions& timeline, SubmitQueue& queue, uint32_t framesInFlight)
+	: device_(device), timeline_(timeline), queue_(queue), semaphore_(VK_NULL_HANDLE), currentFrame_(0), lastTicket_(0)
+{
+	const VkSemaphoreTypeCreateInfoKHR typeCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+		.initialValue = 0,
+	};
+	const VkSemaphoreCreateInfo semaphoreCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &typeCreateInfo,
+	};
+	if (vkCreateSemaphore(device_, &semaphoreCreateInfo, nullptr, &semaphore_) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create async compute timeline semaphore");
+	}
+
+	const VkCommandPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = queue_.family(),
+	};
+	pools_.resize(framesInFlight);
+	for (auto& pool : pools_) {
+		if (vkCreateCommandPool(device_, &poolCreateInfo, nullptr, &pool.commandPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create async compute command pool");
+		}
+	}
+}
+
+AsyncCompute::~AsyncCompute()
+{
+	if (lastTicket_ > 0) {
+		wait(lastTicket_);
+	}
+	for (const auto& pool : pools_) {
+		vkDestroyCommandPool(device_, pool.commandPool, nullptr);
+	}
+	vkDestroySemaphore(device_, semaphore_, nullptr);
+}
+
+void AsyncCompute::beginFrame(uint32_t frameIndex)
+{
+	currentFrame_ = frameIndex;
+	auto& pool = pools_[frameIndex];
+	if (pool.lastTicket > 0) {
+		wait(pool.lastTicket);
+	}
+	vkResetCommandPool(device_, pool.commandPool, 0);
+	pool.used = 0;
+}
+
+AsyncCompute::Ticket AsyncCompute::submit(const RecordFunction& record, std::span<const Wait> waits)
+{
+	auto& pool = pools_[currentFrame_];
+	if (pool.used == pool.commandBuffers.size()) {
+		const VkCommandBufferAllocateInfo allocateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = pool.commandPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(device_, &allocateInfo, &commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate async compute command buffer");
+		}
+		pool.commandBuffers.push_back(commandBuffer);
+	}
+	const VkCommandBuffer commandBuffer = pool.commandBuffers[pool.used++];
+
+	const VkCommandBufferBeginInfo beginInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording async compute command buffer");
+	}
+	record(commandBuffer);
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record async compute command buffer");
+	}
+
+	SmallVector<VkSemaphore, 8> waitSemaphores;
+	SmallVector<uint64_t, 8> waitValues;
+	SmallVector<VkPipelineStageFlags, 8> waitStages;
+	for (const auto& wait : waits) {
+		waitSemaphores.push_back(wait.semaphore);
+		waitValues.push_back(wait.value);
+		waitStages.push_back(wait.stage);
+	}
+	const Ticket ticket = lastTicket_ + 1;
+	const VkTimelineSemaphoreSubmitInfoKHR timelineInfo{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+		.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+		.pWaitSemaphoreValues = waitValues.data(),
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &ticket,
+	};
+	const VkSubmitInfo submitInfo{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineInfo,
+		.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+		.pWaitSemaphores = waitSemaphores.data(),
+		.pWaitDstStageMask = waitStages.data(),
+		.commandBufferCount = 1,
+		.pCommandBuffers = &commandBuffer,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &semaphore_,
+	};
+	if (queue_.submit({ &submitInfo, 1 }) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit async compute command buffer");
+	}
+	lastTicket_ = ticket;
+	pool.lastTicket = ticket;
+	return ticket;
+}
+
+bool AsyncCompute::completed(Ticket ticket) const
+{
+	uint64_t value = 0;
+	if (timeline_.getSemaphoreCounterValue(device_, semaphore_, &value) != VK_SUCCESS) {
+		throw std::runtime_error("failed to query async compute timeline semaphore");
+	}
+	return value >= ticket;
+}
+
+void AsyncCompute::wait(Ticket ticket) const
+{
+	const VkSemaphoreWaitInfoKHR waitInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+		.semaphoreCount = 1,
+		.pSemaphores = &semaphore_,
+		.pValues = &ticket,
+	};
+	timeline_.waitSemaphores(device_, &waitInfo, std::numeric_limits<uint64_t>::max());
+}
+
+/*
+ * device feature ʽ
+ *  device ʱֻ feature, ֵ֧ feature ( robustBufferAccess Ե GPU )
+ * һһ feature Ҫôȫ, Ҫôȫ; Required 鲻ʱ׳쳣, Optional ֻԭ
+ * 1.2/1.3  1.0 ֮ feature ʹ VkPhysicalDeviceVulkan1xFeatures, Ͱ汾ʹöӦչĽṹ
+ * ߲ͬʱ pNext , ʱɵ߰ apiVersion ѡ
+ */
+class DeviceFeatures
+{
+public:
+	enum class Requirement
+	{
+		Required,
+		Optional,
+	};
+
+	// ѯʱʹõȫṹ, 1.0  feature  VkPhysicalDeviceFeatures2  features 
+	using Structs = std::tuple<
+		VkPhysicalDeviceFeatures2KHR,
+		VkPhysicalDeviceVulkan11Features,
+		VkPhysicalDeviceVulkan12Features,
+		VkPhysicalDeviceVulkan13Features,
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT,
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR,
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR,
+		VkPhysicalDeviceSynchronization2FeaturesKHR>;
+	static constexpr size_t structCount = std::tuple_size_v<Structs>;
+
+	struct Feature
+	{
+		VkBool32& (*field)(Structs& structs);
+		// ڵĽṹ Structs е±
+		size_t structIndex;
+		std::string_view name;
+	};
+
+	// һͨ DEVICE_FEATURE(Struct, member) ʹ
+	template<auto pMember>
+	static constexpr Feature feature(std::string_view name)
+	{
+		return Feature{ &field<pMember>, structIndexOf<typename MemberClass<decltype(pMember)>::type>(), name };
+	}
+
+	DeviceFeatures();
+
+	// ѯ device ֵ֧ feature, ͬʱ֮ǰ
+	// apiVersion Ϊ instance  device ֵ֧ͬİ汾, ֻѯð汾ĺĽṹ extensions еչṹ
+	// getFeatures2 Ϊ nullptr ʱֻܲѯ 1.0  feature
+	void query(VkPhysicalDevice device, PFN_vkGetPhysicalDeviceFeatures2KHR getFeatures2, uint32_t apiVersion,
+		std::span<const VkExtensionProperties> extensions);
+
+	// һֵ֧ feature, ȫ֧ʱΪ
+	[[nodiscard]] std::optional<std::string_view> missing(std::span<const Feature> features) const;
+	// ȫ֧ʱһ鲢 true, group ֻ
+	bool request(std::string_view group, Requirement requirement, std::span<const Feature> features);
+	[[nodiscard]] bool enabled(const Feature& feature) const;
+
+	//  device ʱֱΪ pEnabledFeatures  pNext, pNext ֻ feature õĽṹ
+	// ָڲ, ٴ query ֮ʧЧ
+	[[nodiscard]] const VkPhysicalDeviceFeatures& features() const { return std::get<0>(enabled_).features; }
+	[[nodiscard]] void* chain();
+	// õ feature , 
+	[[nodiscard]] const std::vector<std::string_view>& enabledNames() const { return enabledNames_; }
+
+private:
+	template<typename Pointer>
+	struct MemberClass;
+	template<typename Class, typename Member>
+	struct MemberClass<Member Class::*>
+	{
+		using type = Class;
+	};
+
+	// VkPhysicalDeviceFeatures  Structs ,  feature ±Ϊ 0  VkPhysicalDeviceFeatures2
+	template<typename Struct>
+	static constexpr size_t structIndexOf()
+	{
+		return []<size_t... indices>(std::index_sequence<indices...>) {
+			size_t index = 0;
+			((std::is_same_v<Struct, std::tuple_element_t<indices, Structs>> ? (index = indices, true) : false) || ...);
+			return index;
+		}(std::make_index_sequence<structCount>{});
+	}
+
+	template<auto pMember>
+	static VkBool32& field(Structs& structs)
+	{
+		using Struct = typename MemberClass<decltype(pMember)>::type;
+		if constexpr (std::is_same_v<Struct, VkPhysicalDeviceFeatures>) {
+			return std::get<VkPhysicalDeviceFeatures2KHR>(structs).features.*pMember;
+		}
+		else {
+			return std::get<Struct>(structs).*pMember;
+		}
+	}
+
+	// ṹ [minVersion, maxVersion) ĺİ汾ڿ, extension ΪʱҪ device ָ֧չ
+	struct Source
+	{
+		uint32_t minVersion;
+		uint32_t maxVersion;
+		const char* extension;
+	};
+	static constexpr std::array<Source, structCount> sources{ {
+		{ VK_API_VERSION_1_0, std::numeric_limits<uint32_t>::max(), nullptr },
+		{ VK_API_VERSION_1_2, std::numeric_limits<uint32_t>::max(), nullptr },
+		{ VK_API_VERSION_1_2, std::numeric_limits<uint32_t>::max(), nullptr },
+		{ VK_API_VERSION_1_3, std::numeric_limits<uint32_t>::max(), nullptr },
+		{ VK_API_VERSION_1_0, VK_API_VERSION_1_2, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME },
+		{ VK_API_VERSION_1_0, VK_API_VERSION_1_2, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME },
+		{ VK_API_VERSION_1_0, VK_API_VERSION_1_3, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME },
+		{ VK_API_VERSION_1_0, VK_API_VERSION_1_3, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME },
+	} };
+
+	// нṹ㲢 sType
+	static Structs makeStructs();
+	//  mask еĽṹ尴˳ pNext , صһ, mask Ϊʱ nullptr
+	static void* link(Structs& structs, const std::array<bool, structCount>& mask);
+
+	Structs supported_;
+	Structs enabled_;
+	// ѯĽṹ
+	std::array<bool, structCount> available_;
+	//  feature õĽṹ
+	std::array<bool, structCount> used_;
+	std::vector<std::string_view> enabledNames_;
+};
+
+#define DEVICE_FEATURE(Struct, member) DeviceFeatures::feature<&Struct::member>(#member)
+
+DeviceFeatures::DeviceFeatures()
+	: supported_(makeStructs()), enabled_(makeStructs()), available_{}, used_{}
+{
+}
+
+DeviceFeatures::Structs DeviceFeatures::makeStructs()
+{
+	return Structs{
+		VkPhysicalDeviceFeatures2KHR{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR },
+		VkPhysicalDeviceVulkan11Features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES },
+		VkPhysicalDeviceVulkan12Features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES },
+		VkPhysicalDeviceVulkan13Features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES },
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT },
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR },
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR },
+		VkPhysicalDeviceSynchronization2FeaturesKHR{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR },
+	};
+}
+
+void* DeviceFeatures::link(Structs& structs, const std::array<bool, structCount>& mask)
+{
+	VkBaseOutStructure* pFirst = nullptr;
+	VkBaseOutStructure* pLast = nullptr;
+	[&]<size_t... indices>(std::index_sequence<indices...>) {
+		([&] {
+			const auto pStruct = reinterpret_cast<VkBaseOutStructure*>(&std::get<indices>(structs));
+			pStruct->pNext = nullptr;
+			if (!mask[indices]) return;
+			if (pLast == nullptr) {
+				pFirst = pStruct;
+			}
+			else {
+				pLast->pNext = pStruct;
+			}
+			pLast = pStruct;
+		}(), ...);
+	}(std::make_index_sequence<structCount>{});
+	return pFirst;
+}
+
+void DeviceFeatures::query(VkPhysicalDevice device, PFN_vkGetPhysicalDeviceFeatures2KHR getFeatures2, uint32_t apiVersion,
+	std::span<const VkExtensionProperties> extensions)
+{
+	supported_ = makeStructs();
+	enabled_ = makeStructs();
+	used_.fill(false);
+	enabledNames_.clear();
+
+	available_.fill(false);
+	available_[0] = true;
+	if (getFeatures2 == nullptr) {
+		vkGetPhysicalDeviceFeatures(device, &std::get<0>(supported_).features);
+		return;
+	}
+	for (const auto [index, source] : sources | std::views::enumerate) {
+		available_[index] = apiVersion >= source.minVersion && apiVersion < source.maxVersion &&
+			(source.extension == nullptr || std::ranges::any_of(extensions, [&source](const VkExtensionProperties& extension) {
+				return std::string_view(source.extension) == extension.extensionName;
+			}));
+	}
+	link(supported_, available_);
+	getFeatures2(device, &std::get<0>(supported_));
+}
+
+std::optional<std::string_view> DeviceFeatures::missing(std::span<const Feature> features) const
+{
+	for (const auto& feature : features) {
+		// field ֻȡ, supported_ ᱻ޸
+		if (!available_[feature.structIndex] || feature.field(const_cast<Structs&>(supported_)) != VK_TRUE) {
+			return feature.name;
+		}
+	}
+	return std::nullopt;
+}
+
+bool DeviceFeatures::request(std::string_view group, Requirement requirement, std::span<const Feature> features)
+{
+	if (const auto name = missing(features)) {
+		if (requirement == Requirement::Required) {
+			throw std::runtime_error(std::format("{}: required device feature {} not supported", group, *name));
+		}
+		std::println("{} disabled: {} not supported", group, *name);
+		return false;
+	}
+	for (const auto& feature : features) {
+		auto& value = feature.field(enabled_);
+		if (value != VK_TRUE) {
+			value = VK_TRUE;
+			enabledNames_.push_back(feature.name);
+		}
+		used_[feature.structIndex] = true;
+	}
+	return true;
+}
+
+bool DeviceFeatures::enabled(const Feature& feature) const
+{
+	return feature.field(const_cast<Structs&>(enabled_)) == VK_TRUE;
+}
+
+void* DeviceFeatures::chain()
+{
+	// VkPhysicalDeviceFeatures2 Ž, 1.0  feature ͨ pEnabledFeatures , û features2 豸Ҳʹ
+	auto mask = used_;
+	mask[0] = false;
+	return link(enabled_, mask);
+}
+
+class VulkanApplication
+{
+public:
+	VulkanApplication(const uint32_t width, const uint32_t height, const std::string_view appName, const ApplicationSettings& settings = {});
+
+	~VulkanApplication();
+
+	VulkanApplication(const VulkanApplication& other) = delete;
+	VulkanApplication(VulkanApplication&& other) noexcept = delete;
+	VulkanApplication& operator=(const VulkanApplication& other) = delete;
+	VulkanApplication& operator=(VulkanApplication&& other) noexcept = delete;
+
+	// ޴ģʽΪ nullptr
+	[[nodiscard]] GLFWwindow* pWindow() const { return pWindow_; }
+	[[nodiscard]] bool headless() const { return settings_.headless; }
+
+	// ¼Ʋύһ֡, Ȼ present
+	//  (ڴС仯) ʱؽ, Сʱһ֡
+	void drawFrame();
+	// С (framebuffer СΪ 0) ʱûпȾͼ
+	[[nodiscard]] bool minimized() const;
+	[[nodiscard]] uint64_t frameCount() const { return frameCount_; }
+
+	// ޳, ¼, Դ, ߱Ȳύ
+	[[nodiscard]] JobSystem& jobSystem() { return *jobSystem_; }
+
+	// 豸֧ descriptor indexing ʱΪ nullptr
+	[[nodiscard]] BindlessHeap* bindlessHeap() { return bindlessHeap_.has_value() ? &*bindlessHeap_ : nullptr; }
+
+	// 豸֧ timeline semaphore ʱΪ nullptr
+	[[nodiscard]] UploadEngine* uploadEngine() { return uploadEngine_.has_value() ? &*uploadEngine_ : nullptr; }
+
+	// ɫĶ, ߳̿ͨ submit ֱύ, Ҫ
+	[[nodiscard]] QueueTopology& queueTopology() { return *queueTopology_; }
+
+	// 豸֧ timeline semaphore ʱΪ nullptr, ʱ compute ֻ¼ͼ command buffer 
+	[[nodiscard]] AsyncCompute* asyncCompute() { return asyncCompute_.has_value() ? &*asyncCompute_ : nullptr; }
+	// һ drawFrame ύͼִ,  compute ȡһ֡Ⱦ ()
+	// timeline semaphore ύȴύ signal; һ֡ûбύ˳ʱ, ʱ host signal ֵ
+	// compute Ⱦöʱ ( graphicsWaitSupported) ׳쳣
+	[[nodiscard]] AsyncCompute::Wait graphicsWait(VkPipelineStageFlags stage)
+	{
+		if (!graphicsWaitSupported()) {
+			throw std::runtime_error("async compute shares the render queue, it can not wait for a graphics submit that comes later");
+		}
+		graphicsWaitValue_ = frameCount_ + 1;
+		return AsyncCompute::Wait{ graphicsTimeline_, graphicsWaitValue_, stage };
+	}
+	// compute ڶĶ, Եȴ֮ͼύ
+	[[nodiscard]] bool graphicsWaitSupported() const { return asyncCompute_.has_value() && !computeSharesRenderQueue_; }
+	// һ drawFrame ύͼ stage ֮ǰȴ ticket Ӧ compute  (޳Ϊ indirect )
+	void waitForCompute(AsyncCompute::Ticket ticket, VkPipelineStageFlags stage) { computeWaits_.push_back(asyncCompute_->after(ticket, stage)); }
+
+	// pipeline cache ļغͱ, ڶԱ
+	struct PipelineCacheStats
+	{
+		// ʱǷɹ˴ϵĻ, ûмʱ rejectReason ¼ԭ
+		bool loadedFromDisk = false;
+		std::string rejectReason;
+		size_t loadedBytes = 0;
+		size_t savedBytes = 0;
+	};
+	[[nodiscard]] const PipelineCacheStats& pipelineCacheStats() const { return pipelineCacheStats_; }
+
+	// ÿ memory heap ʹ
+	[[nodiscard]] std::vector<DeviceMemoryAllocator::HeapStats> memoryStats() const { return allocator_->heapStats(); }
+
+	// ֡ͳ, ڼ֡Ķ͵֡
+	[[nodiscard]] FramePacer::Stats framePacingStats() const { return framePacer_.stats(); }
+	[[nodiscard]] std::vector<FramePacer::FrameTiming> frameTimingHistory() const { return framePacer_.history(); }
+
+	// һζص֡и pass  pipeline statistics, Ҫ gpuProfiling 豸֧ pipelineStatisticsQuery
+	[[nodiscard]] const GpuProfiler::FrameStatistics& pipelineStatistics() const { return gpuProfiler_->lastFrameStatistics(); }
+
+private:
+	ApplicationSettings settings_;
+
+private:
+	/*
+	 * ö vulkan ĵ: ȴ nullptr õ, ٴõԴ
+	 * εܱ֮仯 ( surface format), ʱڶε÷ VK_INCOMPLETE, Ҫ²ѯ
+	 *  void ĺ ( vkGetPhysicalDeviceQueueFamilyProperties) 
+	 */
+	template<typename F, typename... Args>
+	using VkResourceT = std::remove_pointer_t<FuncArg<sizeof...(Args) + 1, F>>;
+
+	template<typename F, typename... Args>
+		requires std::invocable<F, Args&&..., uint32_t*, FuncArg<sizeof...(Args) + 1, F>>
+	static auto getVkResource(F func, Args&&... args)
+	{
+		std::vector<VkResourceT<F, Args...>> resources;
+		getVkResourceInto(resources, func, args...);
+		return resources;
+	}
+
+	// öٵṩ (std::vector, SmallVector )
+	//  std::vector 㹻 SmallVector жѷ, ÿִ֡е·
+	template<typename Container, typename F, typename... Args>
+		requires std::invocable<F, Args&&..., uint32_t*, FuncArg<sizeof...(Args) + 1, F>>
+	static void getVkResourceInto(Container& resources, F func, Args&&... args)
+	{
+		using Result = std::invoke_result_t<F, Args&&..., uint32_t*, FuncArg<sizeof...(Args) + 1, F>>;
+		uint32_t count = 0;
+		if constexpr (std::is_void_v<Result>) {
+			func(args..., &count, nullptr);
+			resources.resize(count);
+			func(args..., &count, resources.data());
+		}
+		else {
+			VkResult result;
+			do {
+				if (func(args..., &count, nullptr) != VK_SUCCESS) {
+					throw std::runtime_error("failed to query vulkan resource count");
+				}
+				resources.resize(count);
+				result = func(args..., &count, resources.data());
+			} while (result == VK_INCOMPLETE);
+			if (result != VK_SUCCESS) {
+				throw std::runtime_error("failed to enumerate vulkan resource");
+			}
+		}
+		// ڶεʱҲܱ
+		resources.resize(count);
+	}
+
+private:
+/*
+ * vulkan loader 
+ * ȴ, , вֶͨصĺ vulkan
+ */
+	std::optional<VulkanLoader> vulkanLoader_;
+
+	// Ҫ createWindow ֮ǰ, glfw Ҳʹͬһ loader
+	void createVulkanLoader();
+	void destroyVulkanLoader() noexcept;
+
+private:
+/*
+ * glfw window 
+ */
+	GLFWwindow* pWindow_;
+	// ʱָĴڴС, ޴ģʽ surface û currentExtent, ԴΪĴС
+	VkExtent2D windowExtent_;
+
+	// ڴС仯߽ OUT_OF_DATE / SUBOPTIMAL ʱ, һ֡ؽ
+	bool swapChainOutdated_;
+	// ˢ»ص drawFrame ׳쳣ܴ glfw, ȱ, һ drawFrame ʱ׳
+	std::exception_ptr pendingError_;
+
+	void createWindow(const uint32_t width, const uint32_t height, const std::string_view title);
+	void destroyWindow() noexcept;
+
+	// ׳glfwıеĻ
+	static void checkGlfwError();
+
+private:
+/*
+ * job system 
+ * ߳ϴ, ߳Ϊ job system  0 ߳, ߳ÿ֡ʼʱִ
+ */
+	std::optional<JobSystem> jobSystem_;
+
+	// Ҫ createWindow ֮, ߳񵽴ʱ glfwWaitEvents
+	void createJobSystem();
+	// Ҫʹ job system Ķ֮, destroyWindow ֮ǰ
+	void destroyJobSystem() noexcept;
+
+private:
+/*
+ * Ƿ֤㣬debug
+ */
+#ifdef NODEBUG
+	static constexpr bool enableValiLayer = false;
+	static constexpr bool enableDebugOutput = false;
+#else
+	static constexpr bool enableValiLayer = true;
+	static constexpr bool enableDebugOutput = true;
+	static constexpr VkDebugUtilsMessageSeverityFlagBitsEXT vkMessageSeverityLevel = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
+	static constexpr VkDebugUtilsMessageTypeFlagBitsEXT vkMessageTypes = VK_DEBUG_UTILS_MESSAGE_TYPE_FLAG_BITS_MAX_ENUM_EXT;
+#endif
+
+private:
+/*
+ * instance, extension, layer
+ * instance: vulkanײĶһнԴinstance洢״̬
+ */
+	// ͱһָ룬deviceҲ
+	VkInstance instance_;
+	// vulkanеĻصҲһԴҪ
+	VkDebugUtilsMessengerEXT debugMessenger_;
+	// صͨ pUserData õ,  instance ø (vkDestroyInstance ڼҲϢ)
+	std::unique_ptr<DebugMessageLog> debugLog_;
+	// 1.1 ΪĹ, Ϊѡ VK_KHR_get_physical_device_properties2, ڲѯ 1.0 ֮ feature  property
+	bool physicalDeviceProperties2Supported_;
+	//  instance ʱʹõ apiVersion: loader ֵ֧İ汾, Ϊ 1.3
+	uint32_t instanceApiVersion_;
+
+	void createInstance(const std::string_view appName);
+	void destroyInstance() noexcept;
+
+	// пҪṩ instance  extension
+	// glfw Ҫչ vulkan 봰ڶԽ
+	// VK_EXT_debug_utils չչdebug
+	// ޴ģʽ²Ҫ glfw, Ϊ VK_KHR_surface + VK_EXT_headless_surface
+	static std::vector<const char*> getInstanceRequiredExtensions(bool headless, const std::vector<VkExtensionProperties>& availableExtensions);
+
+	static std::vector<const char*> getRequiredLayers(const std::vector<VkLayerProperties>& availableLayers);
+
+	// debug Ĵ, ֻϢŽ pUserData ָ DebugMessageLog, ڻص߳
+	static VKAPI_ATTR VkBool32 VKAPI_CALL debugHandler(
+		VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+		VkDebugUtilsMessageTypeFlagsEXT messageType,
+		const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+		void* pUserData);
+
+	//Ҫinstance ֶ debugMessenger createdestroy
+	static VkResult createDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger);
+	static void destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator);
+
+private:
+	/*
+	 * surface 
+	 *  instance  surface
+	 * дʱ surface ԽӴ, ޴ģʽ headless surface, ֮Ľ÷ȫͬ
+	 */
+	VkSurfaceKHR surface_;
+
+	void createSurface();
+	void destroySurface() noexcept;
+
+	//  debugMessenger һ, չҪ instance ֶ
+	static VkResult createHeadlessSurfaceEXT(VkInstance instance, const VkHeadlessSurfaceCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface);
+
+private:
+/*
+ * physical device 
+ *  instance õ physical device
+ *  surface ϵõ physical device ԣѡһʵ
+ * features, queue family indices , extensions ڴ logical device
+ * surface capability, format, present mode ڴ swap chain
+ */
+	VkPhysicalDevice physicalDevice_;
+
+	VkPhysicalDeviceProperties physicalDeviceProperties_;
+	//  device ʱõ feature, ֻĲ
+	DeviceFeatures deviceFeatures_;
+	struct QueueFamilyIndices
+	{
+		uint32_t graphicsFamily;
+		uint32_t presentFamily;
+		// ѡֻ֧ transfer Ķ (ͨӦ DMA ), ûʱ graphics ͬ
+		uint32_t transferFamily;
+		// ѡ֧ graphics  compute , ûʱ graphics ͬ (ʹøöеĵڶ)
+		uint32_t computeFamily;
+	};
+	QueueFamilyIndices queueFamilyIndices_;
+
+	std::vector<const char*> deviceExtensions_;
+
+	VkSurfaceCapabilitiesKHR surfaceCapabilities_;
+	VkSurfaceFormatKHR surfaceFormat_;
+	VkPresentModeKHR surfacePresentMode_;
+
+	// кϸ physical device , ѡߵ, õϢ֮ device 
+	void pickPhysicalDevice();
+
+	// ѡ physical device ҪöٵȫϢ (洰ڴС仯 surface capability)
+	// 屣ڿ, ´ʱЩö
+	struct DeviceCapabilities
+	{
+		std::vector<VkExtensionProperties> extensions;
+		std::vector<VkQueueFamilyProperties> queueFamilies;
+		// ÿܷ surface_ present
+		std::vector<VkBool32> presentSupport;
+		// format  present mode һֻм, ڶڲ
+		SmallVector<VkSurfaceFormatKHR, 16> surfaceFormats;
+		SmallVector<VkPresentModeKHR, 8> presentModes;
+	};
+
+	DeviceCapabilities queryDeviceCapabilities(VkPhysicalDevice device) const;
+
+	// ӲҪ physical device 
+	struct DeviceCandidate
+	{
+		VkPhysicalDevice device;
+		VkPhysicalDeviceProperties properties;
+		std::vector<const char*> extensions;
+		QueueFamilyIndices queueFamilyIndices;
+		VkSurfaceCapabilitiesKHR surfaceCapabilities;
+		VkSurfaceFormatKHR surfaceFormat;
+		VkPresentModeKHR presentMode;
+		int64_t score;
+		// ÷ֵ˵, ־
+		std::string scoreDetail;
+	};
+
+	// ӲҪ󲢴, ʱԭ
+	// ѡ豸ϸ, ʹ쳣
+	std::expected<DeviceCandidate, std::string> evaluatePhysicalDevice(VkPhysicalDevice device, const DeviceCapabilities& capabilities) const;
+
+	// 豸ǷΪ settings_.preferredDevice ָ豸
+	bool isPreferredDevice(const VkPhysicalDeviceProperties& properties) const;
+
+	static std::string formatUuid(const uint8_t(&uuid)[VK_UUID_SIZE]);
+
+	// пҪṩ physical device  extension
+	// VK_KHR_SWAPCHAIN_EXTENSION_NAME Ӧչֽ֧
+	static std::expected<std::vector<const char*>, std::string> getRequiredDeviceExtensions(
+		const std::vector<VkExtensionProperties>& availableExtensions);
+
+	// ȱʱʹø豸 feature
+	static constexpr std::array requiredDeviceFeatures{
+		DEVICE_FEATURE(VkPhysicalDeviceFeatures, geometryShader),
+	};
+
+	// Ҫֵ֧Ļӷֵ extension
+	static constexpr std::array<const char*, 4> preferredDeviceExtensions{
+		"VK_KHR_dynamic_rendering",
+		"VK_KHR_synchronization2",
+		"VK_EXT_descriptor_indexing",
+		"VK_KHR_timeline_semaphore",
+	};
+
+	static std::expected<QueueFamilyIndices, std::string> getQueueFamilyIndices(const DeviceCapabilities& capabilities);
+
+	// descriptor indexing (bindless) Ҫ feature ǷѾ
+	bool descriptorIndexingSupported_;
+	VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties_;
+
+	// Ҫ VK_KHR_get_physical_device_properties2, 1.2 »Ҫ VK_EXT_descriptor_indexing  VK_KHR_maintenance3
+	// ֧ʱ extension  deviceFeatures_ õ feature
+	void negotiateDescriptorIndexing(const DeviceCapabilities& capabilities);
+
+	// 1.1 ʹúĵ vkGetPhysicalDeviceFeatures2/Properties2, ʹ KHR չİ汾, ʱΪ nullptr
+	PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2_;
+	PFN_vkGetPhysicalDeviceProperties2KHR getPhysicalDeviceProperties2_;
+
+	// dynamic rendering  synchronization2 Ҫ feature ǷѾ
+	bool dynamicRenderingSupported_;
+
+	// instance  device  1.3 ʱʹúĹ, Ҫ VK_KHR_dynamic_rendering  VK_KHR_synchronization2 ()
+	// ֻ֧߱ùرʱ render graph ʹ VkRenderPass  VkFramebuffer
+	void negotiateDynamicRendering(const DeviceCapabilities& capabilities);
+
+	// timeline semaphore Ҫ feature ǷѾ
+	bool timelineSemaphoreSupported_;
+
+	// instance  device  1.2 ʱʹúĹ, Ҫ VK_KHR_timeline_semaphore
+	void negotiateTimelineSemaphore(const DeviceCapabilities& capabilities);
+
+	//  device, surface Ҫ capability(extent, image count), format, present mode
+	// present mode  policy ѡ,  PresentPolicy
+	static std::expected<std::tuple<VkSurfaceCapabilitiesKHR, VkSurfaceFormatKHR, VkPresentModeKHR>, std::string> getSwapChainSupport(
+		VkPhysicalDevice device, VkSurfaceKHR surface, const DeviceCapabilities& capabilities, PresentPolicy policy);
+
+private:
+/*
+ * capability snapshot 
+ * ʱöٵõ layer, extension, , surface format, present mode ȱ浽ִļԱ
+ * ´ʱ豸ûб仯, ֱʹÿеĽ, öٺ豸
+ * - instance Ϣڴ instance ֮ǰ޷֤,  vkCreateInstance Ϊ layer/extension ڶʧ, ö
+ * - device Ϣ physical device  (vendorID, deviceID, driverVersion, pipelineCacheUUID) Ϊ,
+ *   »豸仯ʱԶʧЧ
+ */
+	struct DeviceKey
+	{
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+
+		bool operator==(const DeviceKey& other) const = default;
+	};
+
+	struct CapabilitySnapshot
+	{
+		std::vector<std::string> layers;
+		std::vector<std::string> instanceExtensions;
+		// ɿʱ, 뵱ǰòͬʱ device ϢʧЧ
+		bool headless;
+		std::string preferredDevice;
+		// ɿʱ physical device ıʶ (ö˳), Ϊձʾû device Ϣ
+		std::vector<DeviceKey> deviceKeys;
+		uint32_t pickedDevice;
+		DeviceCapabilities pickedCapabilities;
+	};
+	std::optional<CapabilitySnapshot> capabilitySnapshot_;
+	// ˿, Ҫдش
+	bool capabilitySnapshotDirty_;
+
+	// ļʽ, ޸ CapabilitySnapshot лʽʱ汾
+	static constexpr uint32_t capabilitySnapshotMagic = 0x50414356; // "VCAP"
+	static constexpr uint32_t capabilitySnapshotVersion = 1;
+
+	static std::filesystem::path getCapabilitySnapshotPath();
+	void loadCapabilitySnapshot();
+	// дʧֻӰ´ٶ, ׳쳣
+	void saveCapabilitySnapshot() const noexcept;
+
+private:
+/* logical device 
+ *  logical device, õ queue
+ */
+
+	VkDevice device_;
+	//  settings_ иɫ󴴽Ķ,  device ͬʱ
+	std::optional<QueueTopology> queueTopology_;
+	//  device ֮, ֧ dynamic rendering ʱΪ
+	std::optional<RenderGraph::DynamicRendering> dynamicRendering_;
+	//  device ֮, ֧ timeline semaphore ʱΪ
+	std::optional<TimelineSemaphoreFunctions> timelineSemaphore_;
+	
+	//  physical  logical device  family  queue
+	void createLogicalDevice();
+	void destroyLogicalDevice() noexcept;
+
+private:
+/*
+ * pipeline cache 
+ * ߵıڿִļԱ, ´ʱֱӼ
+ * ݵļͷ뵱ǰ physical device ƥ (vendorID, deviceID, pipelineCacheUUID), 
+ */
+	VkPipelineCache pipelineCache_;
+	PipelineCacheStats pipelineCacheStats_;
+
+	void createPipelineCache();
+	// ǰѻдش (дʱļ, ;˳𻵵Ļ)
+	void destroyPipelineCache() noexcept;
+
+	static std::filesystem::path getPipelineCachePath();
+	// ļڿִļĿ¼
+	static std::filesystem::path getExecutableDirectory();
+
+	// 黺Ƿڸ device, ԵĻؿ, 򷵻ԭ
+	static std::optional<std::string> checkPipelineCacheHeader(std::span<const char> data, const VkPhysicalDeviceProperties& properties);
+
+private:
+/*
+ * GPU profiler 
+ * ûʱ profiler Ȼ, вǿղ, ¼ƴ벻Ҫж
+ */
+	std::optional<GpuProfiler> gpuProfiler_;
+
+	void createGpuProfiler();
+	// ܲд trace, Ҫ vkDeviceWaitIdle ֮
+	void destroyGpuProfiler() noexcept;
+
+private:
+/*
+ * device memory 
+ * Դڴ涼ͨ allocator , ֱӵ vkAllocateMemory
+ */
+	std::optional<DeviceMemoryAllocator> allocator_;
+
+	void createAllocator();
+	// ҪԴ֮
+	void destroyAllocator() noexcept;
+
+private:
+/*
+ * bindless 
+ * 豸֧ descriptor indexing ʱȫֵ bindless Դ, ÿ֡¼֮ǰд descriptor
+ * 鳤ȡ settings е豸 update-after-bind еĽСֵ
+ */
+	std::optional<BindlessHeap> bindlessHeap_;
+
+	void createBindlessHeap();
+	// Ҫ vkDeviceWaitIdle ֮
+	void destroyBindlessHeap() noexcept;
+
+private:
+/*
+ * upload 
+ * 豸֧ timeline semaphore ʱ, ύ transfer , ÿ֡¼ command buffer ʱ acquire ɵϴ
+ */
+	std::optional<UploadEngine> uploadEngine_;
+
+	void createUploadEngine();
+	// Ҫ destroyAllocator ֮ǰ
+	void destroyUploadEngine() noexcept;
+
+private:
+/*
+ * async compute 
+ * 豸֧ timeline semaphore ʱ, ύ compute , ͼύ֮ͨ graphicsWait  waitForCompute ʽ
+ */
+	std::optional<AsyncCompute> asyncCompute_;
+	// һͼύҪȴ compute, ύ
+	std::vector<AsyncCompute::Wait> computeWaits_;
+	// graphicsWait ȥֵ
+	uint64_t graphicsWaitValue_;
+	// compute Ⱦʹͬһ VkQueue, ʱܵȴ֮ͼύ
+	bool computeSharesRenderQueue_;
+
+	void createAsyncCompute();
+	// Ҫ vkDeviceWaitIdle ֮
+	void destroyAsyncCompute() noexcept;
+	// graphicsWait ȥֵûбύʱ (С, acquire ʧܻ֡ѭ),  host signal ,
+	// ȴ compute Զ, vkDeviceWaitIdle һֱ; Ҫ vkDeviceWaitIdle ֮ǰ
+	void releaseGraphicsWaits() noexcept;
+
+private:
+/*
+ * swap chain 
+ * ؽʱѾɽΪ oldSwapchain , ԸԴ, ɽѾύͼȻ present
+ * ɽ, ǵȵʹùִ֡ (ͨ֡ fence ж), ؽʱҪ vkDeviceWaitIdle
+ */
+	VkSwapchainKHR swapChain_;
+	std::vector<VkImage> swapChainImages_;
+	// Ϊ render graph  attachment ʹ
+	std::vector<VkImageView> swapChainImageViews_;
+	// Ⱦɵ semaphore ͼǰ֡:
+	// present һֱֱͼٴα acquire, ֡ present ǰ
+	std::vector<VkSemaphore> renderFinishedSemaphores_;
+
+	struct RetiredSwapChain
+	{
+		VkSwapchainKHR swapChain;
+		std::vector<VkImageView> imageViews;
+		std::vector<VkSemaphore> renderFinishedSemaphores;
+		// ɵ render graph еʱͼܻͬڱ in flight ֡ʹ
+		std::unique_ptr<RenderGraph> renderGraph;
+		// ؽʱ frameCount_, ڴ֮ǰύ֡ʹþɽ
+		uint64_t retiredAtFrame;
+	};
+	std::vector<RetiredSwapChain> retiredSwapChains_;
+
+	void createSwapChain(VkSwapchainKHR oldSwapChain);
+	// ͬʱлûٵľɽ
+	void destroySwapChain() noexcept;
+
+	//  surface capability ʹڴСĴС, СʱΪ 0
+	VkExtent2D chooseSwapChainExtent() const;
+	// ²ѯ surface capability ؽ, Сʱؽ false
+	bool recreateSwapChain();
+	// all Ϊ false ʱֻٲٱκ in flight ֡ʹõľɽ
+	void destroyRetiredSwapChains(bool all) noexcept;
+
+private:
+/*
+ * render graph 
+ * ÿ֡ pass  render graph , barrier Ͳת render graph 
+ * render graph ĴС͸ʽ, 潻һ𴴽, ؽʱɵ render graph ɽһӳ
+ */
+	std::unique_ptr<RenderGraph> renderGraph_;
+	// ĵǰ֡Ľͼ
+	RenderGraph::ResourceId backBuffer_;
+
+	//  createSwapChain е
+	void buildRenderGraph(VkExtent2D extent);
+
+private:
+/*
+ * frame 
+ * ÿ in flight ֡ӵԼ command pool, fence  semaphore
+ * ĳһ֡Դǰȵȴ fence, ֻ framesInFlight ֡ͬʱ GPU 
+ * ֡ڵĻ commandRecorder_ ڶ߳¼Ϊ secondary command buffer,  primary ˳ִ
+ */
+	struct FrameResources
+	{
+		// ÿ֡ reset command pool,  reset command buffer С
+		VkCommandPool commandPool;
+		VkCommandBuffer commandBuffer;
+		// ֡ύִʱ signal
+		VkFence inFlightFence;
+		// acquire ͼʱ signal
+		VkSemaphore imageAvailableSemaphore;
+	};
+	std::vector<FrameResources> frames_;
+	uint32_t currentFrame_;
+	uint64_t frameCount_;
+	std::optional<CommandRecorder> commandRecorder_;
+	// ÿͼύ signal frameCount_ + 1,  compute ȴ; ֧ timeline semaphore ʱΪվ
+	VkSemaphore graphicsTimeline_;
+
+	void createFrameResources();
+	void destroyFrameResources() noexcept;
+
+	// ύʱҪ upload engine  timeline semaphore ϵȴֵ, 0 ʾҪȴ
+	uint64_t recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+private:
+/*
+ * frame pacing 
+ * 豸֧ VK_GOOGLE_display_timing ʱ, present ʱ presentID, ֮ÿ֡ȡѾʾ֡ʵʾʱ
+ * ֻʹ CPU ʱ
+ */
+	FramePacer framePacer_;
+	bool displayTimingSupported_;
+	PFN_vkGetPastPresentationTimingGOOGLE getPastPresentationTiming_;
+	// , ÿ֡ȡʾʱʱڴ
+	std::vector<VkPastPresentationTimingGOOGLE> pastPresentationTimings_;
+
+	//  (ؽ) ֮, ˢں display timing ݶĳһ
+	void configureFramePacing();
+	void collectPresentationTimings();
+
+};
+
+VkResult VulkanApplication::createDebugUtilsMessengerEXT(VkInstance instance,
+	const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator,
+	VkDebugUtilsMessengerEXT* pDebugMessenger) {
+	if (const auto func = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT")); func != nullptr) {
+		return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
+	}
+	else {
+		return VK_ERROR_EXTENSION_NOT_PRESENT;
+	}
+}
+
+void VulkanApplication::destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger,
+	const VkAllocationCallbacks* pAllocator) {
+	if (const auto func = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+		vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT")); func != nullptr) {
+		func(instance, debugMessenger, pAllocator);
+	}
+}
+
+VkResult VulkanApplication::createHeadlessSurfaceEXT(VkInstance instance,
+	const VkHeadlessSurfaceCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator,
+	VkSurfaceKHR* pSurface) {
+	if (const auto func = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT")); func != nullptr) {
+		return func(instance, pCreateInfo, pAllocator, pSurface);
+	}
+	else {
+		return VK_ERROR_EXTENSION_NOT_PRESENT;
+	}
+}
+
+void VulkanApplication::createWindow(const uint32_t width, const uint32_t height, const std::string_view title)
+{
+	windowExtent_ = { width, height };
+	// ޴ģʽȫʹ glfw (ûʾʱ glfwInit Ϳʧ)
+	if (settings_.headless) {
+		return;
+	}
+	try {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+		//  glfw Լټһ loader
+		glfwInitVulkanLoader(vkGetInstanceProcAddr);
+#endif
+		if (glfwInit() != GLFW_TRUE) {
+			throw std::runtime_error("glfw init failed");
+		}
+		// ҪopenGL
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+
+		pWindow_ = glfwCreateWindow(width, height, title.data(), nullptr, nullptr);
+		checkGlfwError();
+
+		glfwSetWindowUserPointer(pWindow_, this);
+		// ֻ, һ drawFrame ʱؽ
+		glfwSetFramebufferSizeCallback(pWindow_, [](GLFWwindow* pWindow, int width, int height) {
+			static_cast<VulkanApplication*>(glfwGetWindowUserPointer(pWindow))->swapChainOutdated_ = true;
+		});
+		// windows ϶ڱ߿ʱ glfwPollEvents ͣϵͳģ̬ѭ, ѭ޷
+		// ˢ»صл, ֤϶л
+		glfwSetWindowRefreshCallback(pWindow_, [](GLFWwindow* pWindow) {
+			auto pApplication = static_cast<VulkanApplication*>(glfwGetWindowUserPointer(pWindow));
+			if (pApplication->pendingError_ != nullptr) return;
+			try {
+				pApplication->drawFrame();
+			}
+			catch (...) {
+				pApplication->pendingError_ = std::current_exception();
+			}
+		});
+	}
+	catch (const std::exception& e)
+	{
+		destroyWindow();
+		throw;
+	}
+}
+
+void VulkanApplication::destroyWindow() noexcept
+{
+	if (settings_.headless) {
+		return;
+	}
+	if (pWindow_ != nullptr) {
+		glfwDestroyWindow(pWindow_);
+	}
+	glfwTerminate();
+}
+
+void VulkanApplication::createJobSystem()
+{
+	const uint32_t workerThreads = settings_.workerThreads != 0 ? settings_.workerThreads :
+		std::max(std::thread::hardware_concurrency(), 1u) - 1;
+	jobSystem_.emplace(workerThreads);
+	if (!settings_.headless) {
+		// glfwPostEmptyEvent ̵߳
+		jobSystem_->setMainThreadWakeup([] { glfwPostEmptyEvent(); });
+	}
+	if constexpr (enableDebugOutput) {
+		std::println("job system: {} worker threads", workerThreads);
+	}
+}
+
+void VulkanApplication::destroyJobSystem() noexcept
+{
+	jobSystem_.reset();
+}
+
+void VulkanApplication::checkGlfwError()
+{
+	std::string error;
 	const char* description;
 	bool isError = false;
 
-	while (glfwGetError(&description) != GLFW_NO_ERROR)
-	{
-		isError = true;
-		error.append(description).append("\n");
+	while (glfwGetError(&description) != GLFW_NO_ERROR)
+	{
+		isError = true;
+		error.append(description).append("\n");
+	}
+	if (isError) {
+		glfwTerminate();
+		throw std::runtime_error(error);
+	}
+}
+
+void VulkanApplication::createInstance(const std::string_view appName) {
+	/*
+		 * 1. appInfo
+		 * 2. createInfoָappInfo
+		 * 3. createInstanceinstance
+		*/
+	//  info ṹ sType ԱҪʽ
+	// create allocator
+	// ѡ֤
+
+	// 1.0  loader û vkEnumerateInstanceVersion, Ҳܸߵ apiVersion
+	instanceApiVersion_ = VK_API_VERSION_1_0;
+	if (const auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+		vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion")); enumerateInstanceVersion != nullptr) {
+		uint32_t version = VK_API_VERSION_1_0;
+		if (enumerateInstanceVersion(&version) == VK_SUCCESS) {
+			instanceApiVersion_ = std::min(version, VK_API_VERSION_1_3);
+		}
+	}
+
+	VkApplicationInfo appInfo{
+		.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+		.pApplicationName = appName.data(),
+		.applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+		.engineVersion = VK_MAKE_VERSION(1, 0, 0),
+		// 1.3 µ device Ȼֻʹ 1.0 Ĺܺչ,  negotiateDynamicRendering
+		.apiVersion = instanceApiVersion_,
+	};
+
+	// пʱֱʹм¼ layer  extension, ö
+	const bool fromSnapshot = capabilitySnapshot_.has_value();
+	std::vector<VkLayerProperties> availableLayers;
+	std::vector<VkExtensionProperties> availableExtensions;
+	if (fromSnapshot) {
+		for (const auto& name : capabilitySnapshot_->layers) {
+			auto& layer = availableLayers.emplace_back(VkLayerProperties{});
+			name.copy(layer.layerName, VK_MAX_EXTENSION_NAME_SIZE - 1);
+		}
+		for (const auto& name : capabilitySnapshot_->instanceExtensions) {
+			auto& extension = availableExtensions.emplace_back(VkExtensionProperties{});
+			name.copy(extension.extensionName, VK_MAX_EXTENSION_NAME_SIZE - 1);
+		}
+	}
+	else {
+		availableLayers = StartupProfiler::instance().measure("vkEnumerateInstanceLayerProperties", [&] {
+			return getVkResource(vkEnumerateInstanceLayerProperties);
+		});
+		availableExtensions = StartupProfiler::instance().measure("vkEnumerateInstanceExtensionProperties", [&] {
+			return getVkResource(vkEnumerateInstanceExtensionProperties, nullptr);
+		});
+		// µĿ, device Ϣ pickPhysicalDevice в
+		capabilitySnapshot_.emplace(CapabilitySnapshot{
+			.layers = availableLayers | std::views::transform(&VkLayerProperties::layerName) | std::ranges::to<std::vector<std::string>>(),
+			.instanceExtensions = availableExtensions | std::views::transform(&VkExtensionProperties::extensionName) | std::ranges::to<std::vector<std::string>>(),
+			.headless = settings_.headless,
+			.preferredDevice = settings_.preferredDevice,
+			.pickedDevice = 0,
+		});
+		capabilitySnapshotDirty_ = true;
+	}
+
+	auto requiredExtensions = getInstanceRequiredExtensions(settings_.headless, availableExtensions);
+	// ѡ instance extension, ֧ʱ
+	physicalDeviceProperties2Supported_ = instanceApiVersion_ >= VK_API_VERSION_1_1;
+	if (!physicalDeviceProperties2Supported_ && std::ranges::any_of(availableExtensions, [](const VkExtensionProperties& extension) {
+		return std::string_view(extension.extensionName) == VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME;
+	})) {
+		physicalDeviceProperties2Supported_ = true;
+		requiredExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	}
+	const auto requiredLayers = getRequiredLayers(availableLayers);
+	// checkExtensionSupport(requiredExtensions);
+	// checkLayerSupport(requiredLayers_);
+
+	VkInstanceCreateInfo createInfo{
+		.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+		.pApplicationInfo = &appInfo,
+		.enabledLayerCount = static_cast<uint32_t>(requiredLayers.size()),
+		.ppEnabledLayerNames = requiredLayers.data(),
+		.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size()),
+		.ppEnabledExtensionNames = requiredExtensions.data(),
+	};
+
+	//  false ʾѾ (жĳ layer), Ҫö
+	auto instanceCreater = [&createInfo, fromSnapshot, this]() {
+		const auto result = StartupProfiler::instance().measure("vkCreateInstance", [&] {
+			return vkCreateInstance(&createInfo, nullptr, &instance_);
+		});
+		if (fromSnapshot && (result == VK_ERROR_LAYER_NOT_PRESENT || result == VK_ERROR_EXTENSION_NOT_PRESENT)) {
+			return false;
+		}
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("failed to create vulkan instance");
+		}
+		vulkanLoader_->loadInstance(instance_);
+		return true;
+	};
+
+	if constexpr (enableValiLayer) {
+		if (debugLog_ == nullptr) {
+			debugLog_ = std::make_unique<DebugMessageLog>(DebugMessageLog::Config{
+				.rateLimit = settings_.validationRateLimit,
+				.rateLimitOverrides = settings_.validationRateLimitOverrides,
+				.summaryInterval = std::chrono::seconds(settings_.validationSummaryInterval),
+			});
+		}
+		/*
+			* VkDebugUtilsMessengerCreateInfoEXT: ҪصϢ͡صָ
+			*/
+		VkDebugUtilsMessengerCreateInfoEXT debugMessengerCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
+			.messageSeverity =
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
+			.messageType =
+			VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
+			.pfnUserCallback = debugHandler,
+			.pUserData = debugLog_.get()
+		};
+		createInfo.pNext = &debugMessengerCreateInfo;
+
+		if (!instanceCreater()) {
+			capabilitySnapshot_.reset();
+			createInstance(appName);
+			return;
+		}
+
+		if (createDebugUtilsMessengerEXT(instance_, &debugMessengerCreateInfo, nullptr, &debugMessenger_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create debug messenger");
+		}
+	}
+	else {
+		if (!instanceCreater()) {
+			capabilitySnapshot_.reset();
+			createInstance(appName);
+		}
+	}
+}
+
+void VulkanApplication::destroyInstance() noexcept {
+	if constexpr (enableValiLayer) {
+		destroyDebugUtilsMessengerEXT(instance_, debugMessenger_, nullptr);
+	}
+	vkDestroyInstance(instance_, nullptr);
+	if constexpr (enableValiLayer) {
+		if constexpr (enableDebugOutput) {
+			const auto stats = debugLog_->stats();
+			std::println("validation layer: {} messages, {} dropped, {} truncated", stats.pushed, stats.dropped, stats.truncated);
+		}
+		// дʣϢ̨߳
+		debugLog_.reset();
+	}
+}
+
+
+void VulkanApplication::pickPhysicalDevice()
+{
+	/*
+	 * 1. ÿ physical device ӲҪ (feature, extension, queue family, swap chain support)
+	 * 2. Ҫİ 豸, ԴС, limits, , ѡ extension 
+	 *    ͵豸 (Կ lavapipe  CPU ʵ), ֻһϸ豸ʱܻѡ
+	 * 3. settings_.preferredDevice ָ豸ֱǰ
+	 * 4. ѡߵ豸, ֵ
+	 * е豸б뵱ǰһʱ, ֻÿе capability ¼ϴѡе豸
+	 */
+	std::vector<VkPhysicalDevice> devices = StartupProfiler::instance().measure("vkEnumeratePhysicalDevices", [&] {
+		return getVkResource(vkEnumeratePhysicalDevices, instance_);
+	});
+
+	// ֻ instance, ѡ豸 feature ʱҪ
+	getPhysicalDeviceFeatures2_ = nullptr;
+	getPhysicalDeviceProperties2_ = nullptr;
+	if (physicalDeviceProperties2Supported_) {
+		const bool core = instanceApiVersion_ >= VK_API_VERSION_1_1;
+		getPhysicalDeviceFeatures2_ = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+			vkGetInstanceProcAddr(instance_, core ? "vkGetPhysicalDeviceFeatures2" : "vkGetPhysicalDeviceFeatures2KHR"));
+		getPhysicalDeviceProperties2_ = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+			vkGetInstanceProcAddr(instance_, core ? "vkGetPhysicalDeviceProperties2" : "vkGetPhysicalDeviceProperties2KHR"));
+	}
+
+	// vkGetPhysicalDeviceProperties Ҫö, ۿԺ
+	std::vector<DeviceKey> deviceKeys;
+	for (const auto device : devices) {
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device, &properties);
+		auto& key = deviceKeys.emplace_back(DeviceKey{
+			.vendorID = properties.vendorID,
+			.deviceID = properties.deviceID,
+			.driverVersion = properties.driverVersion,
+		});
+		std::ranges::copy(properties.pipelineCacheUUID, key.pipelineCacheUUID);
+	}
+
+	auto& snapshot = *capabilitySnapshot_;
+	const bool snapshotValid = !snapshot.deviceKeys.empty() && snapshot.deviceKeys == deviceKeys &&
+		snapshot.headless == settings_.headless && snapshot.preferredDevice == settings_.preferredDevice &&
+		snapshot.pickedDevice < devices.size();
+
+	std::optional<DeviceCandidate> best;
+	if (snapshotValid) {
+		auto candidate = evaluatePhysicalDevice(devices[snapshot.pickedDevice], snapshot.pickedCapabilities);
+		if (candidate.has_value()) {
+			best = std::move(*candidate);
+		}
+		else if constexpr (enableDebugOutput) {
+			std::println("capability snapshot: cached device rejected, {}", candidate.error());
+		}
+	}
+	else if constexpr (enableDebugOutput) {
+		std::println("capability snapshot: device list, driver or settings changed, enumerating");
+	}
+
+	// ʧЧ߿е豸ٺϸʱ, öٲ豸
+	uint32_t bestIndex = snapshot.pickedDevice;
+	std::optional<DeviceCapabilities> bestCapabilities;
+	if (!best.has_value()) {
+		for (const auto [index, device] : devices | std::views::enumerate) {
+			auto capabilities = queryDeviceCapabilities(device);
+			auto candidate = evaluatePhysicalDevice(device, capabilities);
+			if (!candidate.has_value()) {
+				if constexpr (enableDebugOutput) {
+					VkPhysicalDeviceProperties properties;
+					vkGetPhysicalDeviceProperties(device, &properties);
+					std::println("physical device {} rejected: {}", properties.deviceName, candidate.error());
+				}
+				continue;
+			}
+			if constexpr (enableDebugOutput) {
+				std::println("physical device {} (uuid {}) score {}: {}",
+					candidate->properties.deviceName, formatUuid(candidate->properties.pipelineCacheUUID),
+					candidate->score, candidate->scoreDetail);
+			}
+			if (!best.has_value() || candidate->score > best->score) {
+				best = std::move(*candidate);
+				bestIndex = static_cast<uint32_t>(index);
+				bestCapabilities = std::move(capabilities);
+			}
+		}
+	}
+	if (!best.has_value()) {
+		throw std::runtime_error("can not find suitable physical device");
+	}
+
+	if (bestCapabilities.has_value()) {
+		snapshot.headless = settings_.headless;
+		snapshot.preferredDevice = settings_.preferredDevice;
+		snapshot.deviceKeys = std::move(deviceKeys);
+		snapshot.pickedDevice = bestIndex;
+		snapshot.pickedCapabilities = std::move(*bestCapabilities);
+		capabilitySnapshotDirty_ = true;
+	}
+	else if constexpr (enableDebugOutput) {
+		std::println("capability snapshot: picked device from snapshot");
+	}
+
+	if (!settings_.preferredDevice.empty() && !isPreferredDevice(best->properties)) {
+		std::println("preferred physical device \"{}\" not found or not suitable", settings_.preferredDevice);
+	}
+	// ѡ,  CI Ȼȷʵʹõ豸
+	std::println("picked physical device {} (score {}), present mode {}", best->properties.deviceName, best->score, presentModeName(best->presentMode));
+	if constexpr (enableDebugOutput) {
+		std::println("choose queue family {} for graphics, {} for present, {} for transfer, {} for compute",
+			best->queueFamilyIndices.graphicsFamily, best->queueFamilyIndices.presentFamily,
+			best->queueFamilyIndices.transferFamily, best->queueFamilyIndices.computeFamily);
+	}
+
+	physicalDevice_			= best->device;
+	physicalDeviceProperties_ = best->properties;
+	deviceExtensions_		= std::move(best->extensions);
+	queueFamilyIndices_		= best->queueFamilyIndices;
+	surfaceCapabilities_	= best->surfaceCapabilities;
+	surfaceFormat_			= best->surfaceFormat;
+	surfacePresentMode_		= best->presentMode;
+
+	// ѡ device extension, ֧ʱ
+	displayTimingSupported_ = std::ranges::any_of(snapshot.pickedCapabilities.extensions, [](const VkExtensionProperties& extension) {
+		return std::string_view(extension.extensionName) == VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME;
+	});
+	if (displayTimingSupported_) {
+		deviceExtensions_.push_back(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+	}
+
+	// ֻõ feature,  negotiate* ԼҪĲ
+	deviceFeatures_.query(physicalDevice_, getPhysicalDeviceFeatures2_,
+		std::min(instanceApiVersion_, physicalDeviceProperties_.apiVersion), snapshot.pickedCapabilities.extensions);
+	deviceFeatures_.request("device", DeviceFeatures::Requirement::Required, requiredDeviceFeatures);
+	if (settings_.robustBufferAccess) {
+		deviceFeatures_.request("robust buffer access", DeviceFeatures::Requirement::Optional, std::array{
+			DEVICE_FEATURE(VkPhysicalDeviceFeatures, robustBufferAccess),
+		});
+	}
+	// pass ڻִ secondary command buffer,  query Ҫ̳ (inheritedQueries)
+	if (settings_.gpuProfiling || !settings_.frameTracePath.empty()) {
+		deviceFeatures_.request("pipeline statistics", DeviceFeatures::Requirement::Optional, std::array{
+			DEVICE_FEATURE(VkPhysicalDeviceFeatures, pipelineStatisticsQuery),
+			DEVICE_FEATURE(VkPhysicalDeviceFeatures, inheritedQueries),
+		});
+	}
+	negotiateDescriptorIndexing(snapshot.pickedCapabilities);
+	negotiateDynamicRendering(snapshot.pickedCapabilities);
+	negotiateTimelineSemaphore(snapshot.pickedCapabilities);
+	if constexpr (enableDebugOutput) {
+		std::println("device features: {}", deviceFeatures_.enabledNames() | std::views::join_with(std::string_view(", ")) | std::ranges::to<std::string>());
+	}
+}
+
+void VulkanApplication::negotiateDescriptorIndexing(const DeviceCapabilities& capabilities)
+{
+	descriptorIndexingSupported_ = false;
+	descriptorIndexingProperties_ = VkPhysicalDeviceDescriptorIndexingPropertiesEXT{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT,
+	};
+
+	auto hasExtension = [&](std::string_view name) {
+		return std::ranges::any_of(capabilities.extensions, [name](const VkExtensionProperties& extension) {
+			return name == extension.extensionName;
+		});
+	};
+	const bool core = std::min(instanceApiVersion_, physicalDeviceProperties_.apiVersion) >= VK_API_VERSION_1_2;
+	if (getPhysicalDeviceFeatures2_ == nullptr || getPhysicalDeviceProperties2_ == nullptr ||
+		(!core && (!hasExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) || !hasExtension(VK_KHR_MAINTENANCE3_EXTENSION_NAME)))) {
+		return;
+	}
+
+	// BindlessHeap õȫ feature, 1.2  VkPhysicalDeviceVulkan12Features
+	auto features = []<typename Features>() {
+		return std::array{
+			DEVICE_FEATURE(Features, shaderSampledImageArrayNonUniformIndexing),
+			DEVICE_FEATURE(Features, shaderStorageBufferArrayNonUniformIndexing),
+			DEVICE_FEATURE(Features, descriptorBindingSampledImageUpdateAfterBind),
+			DEVICE_FEATURE(Features, descriptorBindingStorageBufferUpdateAfterBind),
+			DEVICE_FEATURE(Features, descriptorBindingUpdateUnusedWhilePending),
+			DEVICE_FEATURE(Features, descriptorBindingPartiallyBound),
+			DEVICE_FEATURE(Features, descriptorBindingVariableDescriptorCount),
+			DEVICE_FEATURE(Features, runtimeDescriptorArray),
+		};
+	};
+	const auto required = core ? features.operator()<VkPhysicalDeviceVulkan12Features>() :
+		features.operator()<VkPhysicalDeviceDescriptorIndexingFeaturesEXT>();
+	if (!deviceFeatures_.request("bindless", DeviceFeatures::Requirement::Optional, required)) {
+		return;
+	}
+
+	VkPhysicalDeviceProperties2KHR properties2{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR,
+		.pNext = &descriptorIndexingProperties_,
+	};
+	getPhysicalDeviceProperties2_(physicalDevice_, &properties2);
+
+	descriptorIndexingSupported_ = true;
+	if (!core) {
+		deviceExtensions_.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+		deviceExtensions_.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+	}
+}
+
+void VulkanApplication::negotiateDynamicRendering(const DeviceCapabilities& capabilities)
+{
+	dynamicRenderingSupported_ = false;
+	if (!settings_.dynamicRendering || getPhysicalDeviceFeatures2_ == nullptr) {
+		return;
+	}
+
+	// device ʹõĺİ汾 instance  apiVersion 
+	const uint32_t apiVersion = std::min(instanceApiVersion_, physicalDeviceProperties_.apiVersion);
+	std::vector<const char*> extensions;
+	if (apiVersion < VK_API_VERSION_1_3) {
+		extensions = { VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME };
+		// VK_KHR_dynamic_rendering  VK_KHR_depth_stencil_resolve,  1.2 ֮ǰ VK_KHR_create_renderpass2
+		if (apiVersion < VK_API_VERSION_1_2) {
+			extensions.insert(extensions.end(), { VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME });
+		}
+		if (apiVersion < VK_API_VERSION_1_1) {
+			extensions.insert(extensions.end(), { VK_KHR_MULTIVIEW_EXTENSION_NAME, VK_KHR_MAINTENANCE2_EXTENSION_NAME });
+		}
+		for (const auto name : extensions) {
+			if (std::ranges::none_of(capabilities.extensions, [name](const VkExtensionProperties& extension) {
+				return std::string_view(name) == extension.extensionName;
+			})) {
+				std::println("dynamic rendering disabled: {} not supported", name);
+				return;
+			}
+		}
+	}
+
+	const bool supported = apiVersion >= VK_API_VERSION_1_3 ?
+		deviceFeatures_.request("dynamic rendering", DeviceFeatures::Requirement::Optional, std::array{
+			DEVICE_FEATURE(VkPhysicalDeviceVulkan13Features, dynamicRendering),
+			DEVICE_FEATURE(VkPhysicalDeviceVulkan13Features, synchronization2),
+		}) :
+		deviceFeatures_.request("dynamic rendering", DeviceFeatures::Requirement::Optional, std::array{
+			DEVICE_FEATURE(VkPhysicalDeviceDynamicRenderingFeaturesKHR, dynamicRendering),
+			DEVICE_FEATURE(VkPhysicalDeviceSynchronization2FeaturesKHR, synchronization2),
+		});
+	if (!supported) {
+		return;
+	}
+
+	dynamicRenderingSupported_ = true;
+	// չѾΪ
+	for (const auto name : extensions) {
+		if (std::ranges::none_of(deviceExtensions_, [name](const char* enabled) { return std::string_view(name) == enabled; })) {
+			deviceExtensions_.push_back(name);
+		}
+	}
+	if constexpr (enableDebugOutput) {
+		std::println("dynamic rendering: {}", apiVersion >= VK_API_VERSION_1_3 ? "vulkan 1.3" : "VK_KHR_dynamic_rendering");
+	}
+}
+
+void VulkanApplication::negotiateTimelineSemaphore(const DeviceCapabilities& capabilities)
+{
+	timelineSemaphoreSupported_ = false;
+	if (getPhysicalDeviceFeatures2_ == nullptr) {
+		return;
+	}
+
+	const bool core = std::min(instanceApiVersion_, physicalDeviceProperties_.apiVersion) >= VK_API_VERSION_1_2;
+	if (!core && std::ranges::none_of(capabilities.extensions, [](const VkExtensionProperties& extension) {
+		return std::string_view(extension.extensionName) == VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME;
+	})) {
+		std::println("upload engine and async compute disabled: {} not supported", VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		return;
+	}
+
+	const bool supported = core ?
+		deviceFeatures_.request("upload engine and async compute", DeviceFeatures::Requirement::Optional, std::array{
+			DEVICE_FEATURE(VkPhysicalDeviceVulkan12Features, timelineSemaphore),
+		}) :
+		deviceFeatures_.request("upload engine and async compute", DeviceFeatures::Requirement::Optional, std::array{
+			DEVICE_FEATURE(VkPhysicalDeviceTimelineSemaphoreFeaturesKHR, timelineSemaphore),
+		});
+	if (!supported) {
+		return;
+	}
+
+	timelineSemaphoreSupported_ = true;
+	if (!core) {
+		deviceExtensions_.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
 	}
-	if (isError) {
-		glfwTerminate();
-		throw std::runtime_error(error);
+}
+
+VulkanApplication::DeviceCapabilities VulkanApplication::queryDeviceCapabilities(VkPhysicalDevice device) const
+{
+	auto& profiler = StartupProfiler::instance();
+	DeviceCapabilities capabilities;
+	profiler.measure("vkEnumerateDeviceExtensionProperties", [&] {
+		getVkResourceInto(capabilities.extensions, vkEnumerateDeviceExtensionProperties, device, nullptr);
+	});
+	if constexpr (enableDebugOutput) {
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device, &properties);
+		std::println("the available {} device extensions of {} are:", capabilities.extensions.size(), properties.deviceName);
+		for (const auto& [extensionName, specVersion] : capabilities.extensions) {
+			std::println("{} (version {})", extensionName, specVersion);
+		}
 	}
+
+	profiler.measure("vkGetPhysicalDeviceQueueFamilyProperties", [&] {
+		getVkResourceInto(capabilities.queueFamilies, vkGetPhysicalDeviceQueueFamilyProperties, device);
+	});
+	profiler.measure("vkGetPhysicalDeviceSurfaceSupportKHR", [&] {
+		for (uint32_t index = 0; index < capabilities.queueFamilies.size(); index++) {
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, index, surface_, &capabilities.presentSupport.emplace_back(VK_FALSE));
+		}
+	});
+
+	profiler.measure("vkGetPhysicalDeviceSurfaceFormatsKHR", [&] {
+		getVkResourceInto(capabilities.surfaceFormats, vkGetPhysicalDeviceSurfaceFormatsKHR, device, surface_);
+	});
+	profiler.measure("vkGetPhysicalDeviceSurfacePresentModesKHR", [&] {
+		getVkResourceInto(capabilities.presentModes, vkGetPhysicalDeviceSurfacePresentModesKHR, device, surface_);
+	});
+	return capabilities;
 }
 
-void VulkanApplication::createInstance(const std::string_view appName) {
+std::expected<VulkanApplication::DeviceCandidate, std::string> VulkanApplication::evaluatePhysicalDevice(
+	VkPhysicalDevice device, const DeviceCapabilities& capabilities) const
+{
+	DeviceCandidate candidate{ .device = device, .score = 0 };
+	vkGetPhysicalDeviceProperties(device, &candidate.properties);
+	const auto& limits = candidate.properties.limits;
+
 	/*
-		 * 1. appInfo
-		 * 2. createInfoָappInfo
-		 * 3. createInstanceinstance
-		*/
-	//  info ṹ sType ԱҪʽ
-	// create allocator
-	// ѡ֤
+	 * ӲҪ
+	 */
+	DeviceFeatures features;
+	features.query(device, getPhysicalDeviceFeatures2_, std::min(instanceApiVersion_, candidate.properties.apiVersion), capabilities.extensions);
+	if (const auto missing = features.missing(requiredDeviceFeatures)) {
+		return std::unexpected(std::format("device not satisfied {} feature", *missing));
+	}
 
-	VkApplicationInfo appInfo{
-		.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-		.pApplicationName = appName.data(),
-		.applicationVersion = VK_MAKE_VERSION(1, 0, 0),
-		.engineVersion = VK_MAKE_VERSION(1, 0, 0),
-		.apiVersion = VK_API_VERSION_1_0,
-	};
+	const auto& availableExtensions = capabilities.extensions;
+	auto extensions = getRequiredDeviceExtensions(availableExtensions);
+	if (!extensions.has_value()) return std::unexpected(std::move(extensions.error()));
+	candidate.extensions = std::move(*extensions);
 
-	const auto requiredExtensions = getInstanceRequiredExtensions();
-	const auto requiredLayers = getRequiredLayers();
-	// checkExtensionSupport(requiredExtensions);
-	// checkLayerSupport(requiredLayers_);
+	const auto& queueFamilies = capabilities.queueFamilies;
+	auto queueFamilyIndices = getQueueFamilyIndices(capabilities);
+	if (!queueFamilyIndices.has_value()) return std::unexpected(std::move(queueFamilyIndices.error()));
+	candidate.queueFamilyIndices = *queueFamilyIndices;
 
-	VkInstanceCreateInfo createInfo{
-		.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-		.pApplicationInfo = &appInfo,
-		.enabledLayerCount = static_cast<uint32_t>(requiredLayers.size()),
-		.ppEnabledLayerNames = requiredLayers.data(),
-		.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size()),
-		.ppEnabledExtensionNames = requiredExtensions.data(),
-	};
+	auto swapChainSupport = getSwapChainSupport(device, surface_, capabilities, settings_.presentPolicy);
+	if (!swapChainSupport.has_value()) return std::unexpected(std::move(swapChainSupport.error()));
+	std::tie(candidate.surfaceCapabilities, candidate.surfaceFormat, candidate.presentMode) = *swapChainSupport;
 
-	auto instanceCreater = [&createInfo, this]() {
-		if (vkCreateInstance(&createInfo, nullptr, &instance_) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create vulkan instance");
-		}
+	/*
+	 * 
+	 */
+	std::vector<std::string> details;
+	auto addScore = [&candidate, &details](std::string_view item, int64_t points) {
+		candidate.score += points;
+		details.push_back(std::format("{} {:+}", item, points));
 	};
 
-	if constexpr (enableValiLayer) {
-		/*
-			* VkDebugUtilsMessengerCreateInfoEXT: ҪصϢ͡صָ
-			*/
-		VkDebugUtilsMessengerCreateInfoEXT debugMessengerCreateInfo{
-			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
-			.messageSeverity =
-			VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
-			.messageType =
-			VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-			VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
-			.pfnUserCallback = debugHandler,
-			.pUserData = nullptr
-		};
-		createInfo.pNext = &debugMessengerCreateInfo;
-
-		instanceCreater();
+	// 豸;˴µܵ, Ȩ
+	switch (candidate.properties.deviceType) {
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: addScore("discrete", 4000); break;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: addScore("integrated", 2000); break;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: addScore("virtual", 1000); break;
+	case VK_PHYSICAL_DEVICE_TYPE_CPU: addScore("cpu", 500); break;
+	default: addScore("other", 0); break;
+	}
 
-		if (createDebugUtilsMessengerEXT(instance_, &debugMessengerCreateInfo, nullptr, &debugMessenger_) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create debug messenger");
+	//  DEVICE_LOCAL , ÿ 64MB һ
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+	VkDeviceSize deviceLocalSize = 0;
+	for (const auto& heap : std::span(memoryProperties.memoryHeaps, memoryProperties.memoryHeapCount)) {
+		if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+			deviceLocalSize = std::max(deviceLocalSize, heap.size);
 		}
 	}
-	else {
-		instanceCreater();
+	addScore("vram", static_cast<int64_t>(deviceLocalSize >> 26));
+
+	addScore("limits",
+		limits.maxImageDimension2D / 1024 +
+		limits.maxBoundDescriptorSets +
+		limits.maxPushConstantsSize / 64);
+
+	// רõ transfer / compute ʱ, ͼȾ
+	const bool hasTransferFamily = std::ranges::any_of(queueFamilies, [](const VkQueueFamilyProperties& family) {
+		return (family.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+	});
+	const bool hasComputeFamily = std::ranges::any_of(queueFamilies, [](const VkQueueFamilyProperties& family) {
+		return (family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+	});
+	// graphics  present ΪͬһʱͼҪ干
+	const bool sharedPresent = candidate.queueFamilyIndices.graphicsFamily == candidate.queueFamilyIndices.presentFamily;
+	addScore("queues", (hasTransferFamily ? 100 : 0) + (hasComputeFamily ? 100 : 0) + (sharedPresent ? 50 : 0));
+
+	const auto preferredCount = std::ranges::count_if(preferredDeviceExtensions, [&availableExtensions](const char* preferred) {
+		return std::ranges::any_of(availableExtensions, [preferred](const VkExtensionProperties& available) {
+			return std::string_view(preferred) == available.extensionName;
+		});
+	});
+	addScore("extensions", preferredCount * 25);
+
+	if (isPreferredDevice(candidate.properties)) {
+		addScore("preferred", 1'000'000);
 	}
+
+	candidate.scoreDetail = details | std::views::join_with(std::string_view(", ")) | std::ranges::to<std::string>();
+	return candidate;
 }
 
-void VulkanApplication::destroyInstance() noexcept {
-	if constexpr (enableValiLayer) {
-		destroyDebugUtilsMessengerEXT(instance_, debugMessenger_, nullptr);
+bool VulkanApplication::isPreferredDevice(const VkPhysicalDeviceProperties& properties) const
+{
+	const auto& preferred = settings_.preferredDevice;
+	if (preferred.empty()) return false;
+	return std::string_view(properties.deviceName).find(preferred) != std::string_view::npos ||
+		formatUuid(properties.pipelineCacheUUID) == preferred;
+}
+
+std::string VulkanApplication::formatUuid(const uint8_t(&uuid)[VK_UUID_SIZE])
+{
+	std::string str;
+	for (const auto byte : uuid) {
+		str += std::format("{:02x}", byte);
 	}
-	vkDestroyInstance(instance_, nullptr);
+	return str;
 }
 
+std::filesystem::path VulkanApplication::getCapabilitySnapshotPath()
+{
+	return getExecutableDirectory() / "capability_snapshot.bin";
+}
 
-void VulkanApplication::pickPhysicalDevice()
+void VulkanApplication::loadCapabilitySnapshot()
 {
-	std::vector<VkPhysicalDevice> devices = getVkResource(vkEnumeratePhysicalDevices, instance_);
-	for(const auto device: devices) {
-		try {
-			/*
-			 * 1.  property
-			 * 2.  feature
-			 * 3.  extension
-			 * 4.  queue family
-			 * 5.  swap chain support
-			 * 6. ֵ 
-			 */
-			VkPhysicalDeviceProperties deviceProperties;
-			vkGetPhysicalDeviceProperties(device, &deviceProperties);
-			if (deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
-				throw std::runtime_error("device not satisfied VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU");
-			}
-
-			VkPhysicalDeviceFeatures deviceFeatures;
-			vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
-			if (deviceFeatures.geometryShader != VK_TRUE) {
-				throw std::runtime_error("device not satisfied geometryShader feature");
-			}
-
-			auto deviceExtensions = getRequiredDeviceExtensions(device);
-			auto queueFamilyIndices = getQueueFamilyIndices(device, surface_);
-			auto swapChainSupports = getSwapChainSupport(device, surface_);
-
-			physicalDevice_			= device;
-			physicalDeviceFeatures_ = deviceFeatures;
-			deviceExtensions_		= std::move(deviceExtensions);
-			queueFamilyIndices_		= queueFamilyIndices;
-			surfaceCapabilities_	= std::get<0>(swapChainSupports);
-			surfaceFormat_			= std::get<1>(swapChainSupports);
-			surfacePresentMode_		= std::get<2>(swapChainSupports);
-			return;
-		}catch (const std::exception& e) {}
+	const auto path = getCapabilitySnapshotPath();
+	std::vector<char> data;
+	if (std::ifstream file{ path, std::ios::binary | std::ios::ate }; file) {
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(data.data(), static_cast<std::streamsize>(data.size()));
+		if (!file) data.clear();
+	}
+	if (data.empty()) {
+		if constexpr (enableDebugOutput) {
+			std::println("capability snapshot: not found, enumerating");
+		}
+		return;
+	}
+
+	/*
+	 * magic, version
+	 * layers, instance extensions:  + ַ
+	 * headless, preferredDevice, deviceKeys, pickedDevice
+	 * device extensions:  + (, specVersion), ֵֻЧ
+	 * queue families, present support, surface formats, present modes: ԭʼֽ
+	 */
+	BinaryReader reader(data);
+	CapabilitySnapshot snapshot;
+	auto readStrings = [&reader](std::vector<std::string>& strings) {
+		uint32_t count;
+		if (!reader.read(count)) return false;
+		strings.resize(count);
+		return std::ranges::all_of(strings, [&reader](std::string& str) { return reader.readString(str); });
+	};
+	auto readExtensions = [&reader](std::vector<VkExtensionProperties>& extensions) {
+		uint32_t count;
+		if (!reader.read(count)) return false;
+		extensions.resize(count);
+		return std::ranges::all_of(extensions, [&reader](VkExtensionProperties& extension) {
+			std::string name;
+			if (!reader.readString(name) || name.size() >= VK_MAX_EXTENSION_NAME_SIZE) return false;
+			extension = {};
+			name.copy(extension.extensionName, name.size());
+			return reader.read(extension.specVersion);
+		});
+	};
+
+	uint32_t magic = 0, version = 0;
+	// bool һֽڱ, ȶ,  0  1 ֱֽӶ bool δΪ
+	uint8_t headless = 0;
+	auto& capabilities = snapshot.pickedCapabilities;
+	const bool ok =
+		reader.read(magic) && magic == capabilitySnapshotMagic &&
+		reader.read(version) && version == capabilitySnapshotVersion &&
+		readStrings(snapshot.layers) &&
+		readStrings(snapshot.instanceExtensions) &&
+		reader.read(headless) && headless <= 1 &&
+		reader.readString(snapshot.preferredDevice) &&
+		reader.readArray(snapshot.deviceKeys) &&
+		reader.read(snapshot.pickedDevice) &&
+		readExtensions(capabilities.extensions) &&
+		reader.readArray(capabilities.queueFamilies) &&
+		reader.readArray(capabilities.presentSupport) &&
+		reader.readArray(capabilities.surfaceFormats) &&
+		reader.readArray(capabilities.presentModes) &&
+		reader.empty() &&
+		capabilities.presentSupport.size() == capabilities.queueFamilies.size();
+	if (!ok) {
+		// 𻵻߾ɰ汾Ŀյ, ʱḲ
+		if constexpr (enableDebugOutput) {
+			std::println("capability snapshot: {} is invalid, enumerating", path.string());
+		}
+		return;
+	}
+	snapshot.headless = headless != 0;
+
+	if constexpr (enableDebugOutput) {
+		std::println("capability snapshot: loaded {} bytes from {}", data.size(), path.string());
+	}
+	capabilitySnapshot_ = std::move(snapshot);
+}
+
+void VulkanApplication::saveCapabilitySnapshot() const noexcept
+{
+	try {
+		const auto& snapshot = *capabilitySnapshot_;
+		const auto& capabilities = snapshot.pickedCapabilities;
+
+		BinaryWriter writer;
+		writer.write(capabilitySnapshotMagic);
+		writer.write(capabilitySnapshotVersion);
+		auto writeStrings = [&writer](const std::vector<std::string>& strings) {
+			writer.write(static_cast<uint32_t>(strings.size()));
+			for (const auto& str : strings) {
+				writer.writeString(str);
+			}
+		};
+		writeStrings(snapshot.layers);
+		writeStrings(snapshot.instanceExtensions);
+		writer.write(static_cast<uint8_t>(snapshot.headless));
+		writer.writeString(snapshot.preferredDevice);
+		writer.writeArray(snapshot.deviceKeys);
+		writer.write(snapshot.pickedDevice);
+		writer.write(static_cast<uint32_t>(capabilities.extensions.size()));
+		for (const auto& [extensionName, specVersion] : capabilities.extensions) {
+			writer.writeString(extensionName);
+			writer.write(specVersion);
+		}
+		writer.writeArray(capabilities.queueFamilies);
+		writer.writeArray(capabilities.presentSupport);
+		writer.writeArray(capabilities.surfaceFormats);
+		writer.writeArray(capabilities.presentModes);
+
+		const auto& data = writer.data();
+		const auto path = getCapabilitySnapshotPath();
+		auto tempPath = path;
+		tempPath += ".tmp";
+		{
+			std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+			file.write(data.data(), static_cast<std::streamsize>(data.size()));
+			file.close();
+			if (!file) {
+				throw std::runtime_error(std::format("failed to write {}", tempPath.string()));
+			}
+		}
+		std::filesystem::rename(tempPath, path);
+
+		if constexpr (enableDebugOutput) {
+			std::println("capability snapshot: saved {} bytes to {}", data.size(), path.string());
+		}
+	}
+	catch (const std::exception& e) {
+		if constexpr (enableDebugOutput) {
+			std::println("capability snapshot: failed to save, {}", e.what());
+		}
 	}
-	throw std::runtime_error("can not find suitable physical device");
 }
 
 void VulkanApplication::createLogicalDevice()
@@ -403,89 +6536,485 @@ void VulkanApplication::createLogicalDevice()
 	 *
 	 */
 
-	// һ queueCreateInfo Դ ͬ Ķ
-	// queueCreateInfos еÿ queueCreateInfo ҪָͬĶ
-	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+	// һ queueCreateInfo Դ ͬ Ķ, ÿԼȼ
+	// ĶܳӵеĶ, ѾĶ
+	using Role = QueueTopology::Role;
+	queueTopology_.emplace(std::array<QueueTopology::RoleRequest, QueueTopology::roleCount>{ {
+		{ queueFamilyIndices_.graphicsFamily, settings_.renderQueues.count, settings_.renderQueues.priority },
+		//  render ͬһʱõһ render 
+		{ queueFamilyIndices_.presentFamily, 0, settings_.renderQueues.priority },
+		{ queueFamilyIndices_.transferFamily, settings_.streamingQueues.count, settings_.streamingQueues.priority },
+		{ queueFamilyIndices_.computeFamily, settings_.computeQueues.count, settings_.computeQueues.priority },
+	} }, capabilitySnapshot_->pickedCapabilities.queueFamilies);
+	const auto queueCreateInfos = queueTopology_->createInfos();
+
+	const VkDeviceCreateInfo createInfo{
+		.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+		// 1.0 ֮ feature ͨ pNext 
+		.pNext = deviceFeatures_.chain(),
+		.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
+		.pQueueCreateInfos = queueCreateInfos.data(),
+		.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions_.size()),
+		.ppEnabledExtensionNames = deviceExtensions_.data(),
+		.pEnabledFeatures = &deviceFeatures_.features(),
+	};
+
+	// ʵ (instance, physical device)  (logic device) вͬ layer, ʵкϲ
+	// Ҫ enabledLayerCount  ppEnabledLayerNames
+	// createInfo.enabledLayerCount = static_cast<uint32_t>(requiredLayers_.size());
+	// createInfo.ppEnabledLayerNames = requiredLayers_.data();
+
+	const auto result = StartupProfiler::instance().measure("vkCreateDevice", [&] {
+		return vkCreateDevice(physicalDevice_, &createInfo, nullptr, &device_);
+	});
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to create logical device!");
+	}
+	// ֮ device ĵ (vkCmd*, vkQueueSubmit ) ֱӽ
+	vulkanLoader_->loadDevice(device_);
+	queueTopology_->resolve(device_);
+	if constexpr (enableDebugOutput) {
+		for (const auto [role, name] : std::array<std::pair<Role, std::string_view>, QueueTopology::roleCount>{ {
+			{ Role::Render, "render" }, { Role::Present, "present" }, { Role::Streaming, "streaming" }, { Role::Compute, "compute" } } }) {
+			std::println("{} queues: family {}, {} queue(s), priority {}", name, queueTopology_->family(role),
+				queueTopology_->queueCount(role), queueTopology_->queue(role).priority());
+		}
+	}
+
+	dynamicRendering_.reset();
+	if (dynamicRenderingSupported_) {
+		// ĺ KHR ǩͬ, 1.3  device ֻܱ֤ȡú
+		const bool core = std::min(instanceApiVersion_, physicalDeviceProperties_.apiVersion) >= VK_API_VERSION_1_3;
+		const RenderGraph::DynamicRendering functions{
+			.beginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(
+				vkGetDeviceProcAddr(device_, core ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR")),
+			.endRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(
+				vkGetDeviceProcAddr(device_, core ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR")),
+			.pipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(
+				vkGetDeviceProcAddr(device_, core ? "vkCmdPipelineBarrier2" : "vkCmdPipelineBarrier2KHR")),
+		};
+		if (functions.beginRendering == nullptr || functions.endRendering == nullptr || functions.pipelineBarrier2 == nullptr) {
+			throw std::runtime_error("failed to load dynamic rendering functions");
+		}
+		dynamicRendering_ = functions;
+	}
+
+	timelineSemaphore_.reset();
+	if (timelineSemaphoreSupported_) {
+		const bool core = std::min(instanceApiVersion_, physicalDeviceProperties_.apiVersion) >= VK_API_VERSION_1_2;
+		const TimelineSemaphoreFunctions functions{
+			.getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+				vkGetDeviceProcAddr(device_, core ? "vkGetSemaphoreCounterValue" : "vkGetSemaphoreCounterValueKHR")),
+			.waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+				vkGetDeviceProcAddr(device_, core ? "vkWaitSemaphores" : "vkWaitSemaphoresKHR")),
+			.signalSemaphore = reinterpret_cast<PFN_vkSignalSemaphoreKHR>(
+				vkGetDeviceProcAddr(device_, core ? "vkSignalSemaphore" : "vkSignalSemaphoreKHR")),
+		};
+		if (functions.getSemaphoreCounterValue == nullptr || functions.waitSemaphores == nullptr || functions.signalSemaphore == nullptr) {
+			throw std::runtime_error("failed to load timeline semaphore functions");
+		}
+		timelineSemaphore_ = functions;
+	}
+}
+
+void VulkanApplication::destroyLogicalDevice() noexcept
+{
+	vkDestroyDevice(device_, nullptr);
+	queueTopology_.reset();
+}
+
+std::filesystem::path VulkanApplication::getPipelineCachePath()
+{
+	return getExecutableDirectory() / "pipeline_cache.bin";
+}
+
+std::filesystem::path VulkanApplication::getExecutableDirectory()
+{
+	std::filesystem::path executablePath;
+#ifdef _WIN32
+	std::wstring buffer(MAX_PATH, L'\0');
+	const auto length = GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()));
+	buffer.resize(length);
+	executablePath = buffer;
+#else
+	std::error_code ec;
+	executablePath = std::filesystem::read_symlink("/proc/self/exe", ec);
+#endif
+	// òִļ·ʱ˻ΪĿ¼
+	return executablePath.empty() ? std::filesystem::current_path() : executablePath.parent_path();
+}
+
+std::optional<std::string> VulkanApplication::checkPipelineCacheHeader(std::span<const char> data, const VkPhysicalDeviceProperties& properties)
+{
+	/*
+	 *  VkPipelineCacheHeaderVersionOne ͷ:
+	 * headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID
+	 * º pipelineCacheUUID ı, ɻ֮ʧЧ
+	 */
+	VkPipelineCacheHeaderVersionOne header;
+	if (data.size() < sizeof(header)) {
+		return std::format("file too small ({} bytes)", data.size());
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.headerSize < sizeof(header)) {
+		return std::format("unknown header version {} (size {})", static_cast<uint32_t>(header.headerVersion), header.headerSize);
+	}
+	if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID) {
+		return std::format("device mismatch (cache {:#x}:{:#x}, device {:#x}:{:#x})",
+			header.vendorID, header.deviceID, properties.vendorID, properties.deviceID);
+	}
+	if (std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+		return "pipelineCacheUUID mismatch (driver changed)";
+	}
+	return std::nullopt;
+}
+
+void VulkanApplication::createPipelineCache()
+{
+	const auto path = getPipelineCachePath();
+
+	std::vector<char> data;
+	if (std::ifstream file{ path, std::ios::binary | std::ios::ate }; file) {
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(data.data(), static_cast<std::streamsize>(data.size()));
+		if (!file) {
+			data.clear();
+			pipelineCacheStats_.rejectReason = "failed to read file";
+		}
+	}
+	else {
+		pipelineCacheStats_.rejectReason = "file not found";
+	}
+
+	if (!data.empty()) {
+		if (auto reason = checkPipelineCacheHeader(data, physicalDeviceProperties_); reason.has_value()) {
+			pipelineCacheStats_.rejectReason = std::move(*reason);
+			data.clear();
+		}
+	}
+
+	VkPipelineCacheCreateInfo createInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.initialDataSize = data.size(),
+		.pInitialData = data.empty() ? nullptr : data.data(),
+	};
+
+	if (vkCreatePipelineCache(device_, &createInfo, nullptr, &pipelineCache_) == VK_SUCCESS) {
+		pipelineCacheStats_.loadedFromDisk = !data.empty();
+		pipelineCacheStats_.loadedBytes = data.size();
+	}
+	else {
+		// ļͷͨȻ, ˻Ϊջ
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+		if (vkCreatePipelineCache(device_, &createInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache");
+		}
+		pipelineCacheStats_.rejectReason = "rejected by driver";
+	}
 
-	std::vector<uint32_t> indices{ queueFamilyIndices_.graphicsFamily, queueFamilyIndices_.presentFamily };
-	std::map<uint32_t, uint32_t> index2CountMap;
-	std::map<uint32_t, std::vector<float>> index2PrioritiesMap;
-	for (const auto index : indices) {
-		index2PrioritiesMap[index].push_back(1.0f);
-		if (index2CountMap.contains(index)) {
-			index2CountMap[index]++;
+	if constexpr (enableDebugOutput) {
+		if (pipelineCacheStats_.loadedFromDisk) {
+			std::println("pipeline cache: loaded {} bytes from {}", pipelineCacheStats_.loadedBytes, path.string());
 		}
 		else {
-			index2CountMap[index] = 1;
+			std::println("pipeline cache: cold start, {}", pipelineCacheStats_.rejectReason);
 		}
 	}
+}
 
-	for (const auto [index, count] : index2CountMap) {
-		queueCreateInfos.emplace_back(VkDeviceQueueCreateInfo{
-			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-			.queueFamilyIndex = index,
-			.queueCount = count,
-			.pQueuePriorities = index2PrioritiesMap[index].data(),
-		});
+void VulkanApplication::destroyPipelineCache() noexcept
+{
+	try {
+		size_t size = 0;
+		std::vector<char> data;
+		if (vkGetPipelineCacheData(device_, pipelineCache_, &size, nullptr) == VK_SUCCESS && size != 0) {
+			data.resize(size);
+			if (vkGetPipelineCacheData(device_, pipelineCache_, &size, data.data()) != VK_SUCCESS) {
+				data.clear();
+			}
+			data.resize(std::min(size, data.size()));
+		}
+
+		if (!data.empty()) {
+			const auto path = getPipelineCachePath();
+			auto tempPath = path;
+			tempPath += ".tmp";
+			{
+				std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+				file.write(data.data(), static_cast<std::streamsize>(data.size()));
+				file.close();
+				if (!file) {
+					throw std::runtime_error(std::format("failed to write {}", tempPath.string()));
+				}
+			}
+			// ͬһĿ¼µ rename ԭӵ滻ļ
+			std::filesystem::rename(tempPath, path);
+			pipelineCacheStats_.savedBytes = data.size();
+		}
+
+		if constexpr (enableDebugOutput) {
+			std::println("pipeline cache: saved {} bytes", pipelineCacheStats_.savedBytes);
+		}
+	}
+	catch (const std::exception& e) {
+		if constexpr (enableDebugOutput) {
+			std::println("pipeline cache: failed to save, {}", e.what());
+		}
+	}
+	vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
+}
+
+void VulkanApplication::createGpuProfiler()
+{
+	const bool enabled = settings_.gpuProfiling || !settings_.frameTracePath.empty();
+	//  timestampValidBits Ϊ 0 ʱ֧ʱ
+	const auto& queueFamilies = capabilitySnapshot_->pickedCapabilities.queueFamilies;
+	const uint32_t validBits = enabled ? queueFamilies[queueFamilyIndices_.graphicsFamily].timestampValidBits : 0;
+	if (enabled && validBits == 0) {
+		std::println("gpu profiler: graphics queue family does not support timestamps");
+	}
+	//  gpu profiler ʱ pickPhysicalDevice  pipelineStatisticsQuery  inheritedQueries
+	const bool pipelineStatistics = enabled && deviceFeatures_.enabled(DEVICE_FEATURE(VkPhysicalDeviceFeatures, pipelineStatisticsQuery));
+	gpuProfiler_.emplace(device_, physicalDeviceProperties_, validBits, pipelineStatistics, settings_.framesInFlight);
+	// ʱû߳ύ, ֱʹþ
+	gpuProfiler_->calibrate(queueTopology_->queue(QueueTopology::Role::Render).handle(), queueFamilyIndices_.graphicsFamily);
+}
+
+void VulkanApplication::destroyGpuProfiler() noexcept
+{
+	// ֡Ѿִ, ػûжصĽ
+	for (uint32_t i = 0; i < frames_.size(); i++) {
+		gpuProfiler_->collect(i);
+	}
+	if (gpuProfiler_->enabled()) {
+		std::println("gpu timing ({} scopes dropped):", gpuProfiler_->droppedScopes());
+		std::println("{:<32} {:>10} {:>10} {:>10}", "scope", "count", "avg ms", "max ms");
+		for (const auto& [name, count, totalMs, maxMs] : gpuProfiler_->scopeStats()) {
+			std::println("{:<32} {:>10} {:>10.3f} {:>10.3f}", name, count, totalMs / static_cast<double>(count), maxMs);
+		}
+	}
+	if (gpuProfiler_->pipelineStatisticsEnabled()) {
+		std::println("pipeline statistics (average per frame):");
+		std::println("{:<32} {:>10} {:>14} {:>14} {:>14} {:>14}", "pass", "frames", "vertex", "clip prims", "fragment", "compute");
+		for (const auto& [name, count, sum] : gpuProfiler_->passStatistics()) {
+			std::println("{:<32} {:>10} {:>14} {:>14} {:>14} {:>14}", name, count,
+				sum.vertexShaderInvocations / count, sum.clippingPrimitives / count,
+				sum.fragmentShaderInvocations / count, sum.computeShaderInvocations / count);
+		}
+	}
+
+	if (!settings_.frameTracePath.empty()) {
+		try {
+			using Microseconds = std::chrono::duration<double, std::micro>;
+			const auto origin = StartupProfiler::instance().origin();
+			auto events = StartupProfiler::instance().traceEvents();
+			// ÿ֡ CPU ʱ frame pacer ļ¼
+			for (const auto& timing : framePacer_.history()) {
+				events.push_back(TraceEvent{
+					.name = "acquire",
+					.category = "frame",
+					.tid = 2,
+					.startUs = Microseconds(timing.acquireBegin - origin).count(),
+					.durationUs = Microseconds(timing.acquireEnd - timing.acquireBegin).count(),
+				});
+				events.push_back(TraceEvent{
+					.name = "record+submit",
+					.category = "frame",
+					.tid = 2,
+					.startUs = Microseconds(timing.acquireEnd - origin).count(),
+					.durationUs = Microseconds(timing.submit - timing.acquireEnd).count(),
+				});
+				events.push_back(TraceEvent{
+					.name = "present",
+					.category = "frame",
+					.tid = 2,
+					.startUs = Microseconds(timing.submit - origin).count(),
+					.durationUs = Microseconds(timing.present - timing.submit).count(),
+				});
+			}
+			std::ranges::move(gpuProfiler_->traceEvents(origin), std::back_inserter(events));
+			static constexpr std::array<std::pair<uint32_t, std::string_view>, 3> threadNames{ {
+				{ 1, "startup" }, { 2, "cpu frames" }, { 3, "gpu" },
+			} };
+			writeChromeTrace(settings_.frameTracePath, events, threadNames);
+		}
+		catch (const std::exception& e) {
+			std::println("failed to write frame trace: {}", e.what());
+		}
+	}
+	gpuProfiler_.reset();
+}
+
+void VulkanApplication::createAllocator()
+{
+	allocator_.emplace(physicalDevice_, device_);
+}
+
+void VulkanApplication::destroyAllocator() noexcept
+{
+	if constexpr (enableDebugOutput) {
+		for (const auto& [index, stats] : allocator_->heapStats() | std::views::enumerate) {
+			std::println("memory heap {}: {} / {} bytes used in {} allocations ({} blocks, {} dedicated, {} bytes from driver)",
+				index, stats.usedBytes, stats.heapSize, stats.allocationCount, stats.blockCount, stats.dedicatedCount, stats.allocatedBytes);
+		}
+	}
+	allocator_.reset();
+}
+
+void VulkanApplication::createBindlessHeap()
+{
+	if (!descriptorIndexingSupported_) {
+		return;
+	}
+	const auto& limits = descriptorIndexingProperties_;
+	// ͬʱܵ stage  set 
+	BindlessHeap::Capacity capacity{
+		.sampledImages = std::min({ settings_.bindlessCapacity.sampledImages,
+			limits.maxPerStageDescriptorUpdateAfterBindSampledImages, limits.maxDescriptorSetUpdateAfterBindSampledImages }),
+		.samplers = std::min({ settings_.bindlessCapacity.samplers,
+			limits.maxPerStageDescriptorUpdateAfterBindSamplers, limits.maxDescriptorSetUpdateAfterBindSamplers }),
+		.storageBuffers = std::min({ settings_.bindlessCapacity.storageBuffers,
+			limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers, limits.maxDescriptorSetUpdateAfterBindStorageBuffers }),
+	};
+	//  binding ÿ stage ɼ, ֮ͻܳ stage Դ, ʱС
+	const uint64_t total = uint64_t{ capacity.sampledImages } + capacity.samplers + capacity.storageBuffers;
+	if (total > limits.maxPerStageUpdateAfterBindResources) {
+		auto scale = [&](uint32_t count) {
+			return static_cast<uint32_t>(count * uint64_t{ limits.maxPerStageUpdateAfterBindResources } / total);
+		};
+		capacity = {
+			.sampledImages = scale(capacity.sampledImages),
+			.samplers = scale(capacity.samplers),
+			.storageBuffers = scale(capacity.storageBuffers),
+		};
+	}
+
+	// maintenance3  1.1 ΪĹ, 1.0 ʹ˵ VK_KHR_maintenance3
+	const bool core = std::min(instanceApiVersion_, physicalDeviceProperties_.apiVersion) >= VK_API_VERSION_1_1;
+	const auto getLayoutSupport = reinterpret_cast<PFN_vkGetDescriptorSetLayoutSupportKHR>(
+		vkGetDeviceProcAddr(device_, core ? "vkGetDescriptorSetLayoutSupport" : "vkGetDescriptorSetLayoutSupportKHR"));
+	if (getLayoutSupport == nullptr) {
+		throw std::runtime_error("failed to load vkGetDescriptorSetLayoutSupport");
+	}
+	// ʵֻ, ֧ʱ
+	while (!BindlessHeap::layoutSupported(device_, capacity, getLayoutSupport)) {
+		if (capacity.sampledImages <= 1 || capacity.samplers <= 1 || capacity.storageBuffers <= 1) {
+			std::println("bindless heap disabled: descriptor set layout not supported");
+			return;
+		}
+		capacity = {
+			.sampledImages = capacity.sampledImages / 2,
+			.samplers = capacity.samplers / 2,
+			.storageBuffers = capacity.storageBuffers / 2,
+		};
+	}
+	bindlessHeap_.emplace(device_, capacity, settings_.framesInFlight);
+	if constexpr (enableDebugOutput) {
+		std::println("bindless heap: {} sampled images, {} samplers, {} storage buffers",
+			capacity.sampledImages, capacity.samplers, capacity.storageBuffers);
 	}
+}
 
-	VkDeviceCreateInfo createInfo{
-		.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-		.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
-		.pQueueCreateInfos = queueCreateInfos.data(),
-		.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions_.size()),
-		.ppEnabledExtensionNames = deviceExtensions_.data(),
-		.pEnabledFeatures = &physicalDeviceFeatures_,
-	};
-
-	// ʵ (instance, physical device)  (logic device) вͬ layer, ʵкϲ
-	// Ҫ enabledLayerCount  ppEnabledLayerNames
-	// createInfo.enabledLayerCount = static_cast<uint32_t>(requiredLayers_.size());
-	// createInfo.ppEnabledLayerNames = requiredLayers_.data();
+void VulkanApplication::destroyBindlessHeap() noexcept
+{
+	bindlessHeap_.reset();
+}
 
-	if (vkCreateDevice(physicalDevice_, &createInfo, nullptr, &device_) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create logical device!");
+void VulkanApplication::createUploadEngine()
+{
+	if (!timelineSemaphore_.has_value()) {
+		return;
 	}
+	uploadEngine_.emplace(device_, *allocator_, *timelineSemaphore_, UploadEngine::Config{
+		.transferQueue = &queueTopology_->queue(QueueTopology::Role::Streaming),
+		.transferFamily = queueFamilyIndices_.transferFamily,
+		.graphicsFamily = queueFamilyIndices_.graphicsFamily,
+		.stagingSize = settings_.uploadStagingSize,
+		.frameBudget = settings_.uploadFrameBudget,
+	});
+	if constexpr (enableDebugOutput) {
+		std::println("upload engine: queue family {}{}, {} bytes staging, {} bytes per frame",
+			queueFamilyIndices_.transferFamily, uploadEngine_->ownershipTransfer() ? " (ownership transfer)" : "",
+			settings_.uploadStagingSize, settings_.uploadFrameBudget);
+	}
+}
 
-	std::map<uint32_t, uint32_t> family2QueueIndexMap;
-	for (const auto index : index2CountMap | std::views::keys) {
-		family2QueueIndexMap[index] = 0;
+void VulkanApplication::createAsyncCompute()
+{
+	if (!timelineSemaphore_.has_value()) {
+		return;
 	}
-	// Ҫǰ indices Ӧ
-	std::vector<VkQueue Queues::*> pQueues{ &Queues::graphicsQueue, &Queues::presentQueue };
-	for(const auto [familyIndex, pQueue]: std::views::zip(indices, pQueues)) {
-		auto& queueIndex = family2QueueIndexMap[familyIndex];
-		vkGetDeviceQueue(device_, familyIndex, queueIndex, &(queues_.*pQueue));
-		queueIndex++;
+	// timeline semaphore ֵ밴ִ˳, ֻʹõһ compute , Ĺֱ̨ύ
+	using Role = QueueTopology::Role;
+	asyncCompute_.emplace(device_, *timelineSemaphore_, queueTopology_->queue(Role::Compute), settings_.framesInFlight);
+	computeSharesRenderQueue_ = queueTopology_->shared(Role::Compute, 0, Role::Render, 0);
+	if constexpr (enableDebugOutput) {
+		std::println("async compute: queue family {}{}", queueFamilyIndices_.computeFamily,
+			computeSharesRenderQueue_ ? " (shared with render queue, graphics waits disabled)" : "");
 	}
 }
 
-void VulkanApplication::destroyLogicalDevice() noexcept
+void VulkanApplication::releaseGraphicsWaits() noexcept
 {
-	vkDestroyDevice(device_, nullptr);
+	// Ѿύͼ signal ֵ frameCount_
+	if (graphicsTimeline_ == VK_NULL_HANDLE || graphicsWaitValue_ <= frameCount_) return;
+	// host signal ֵСлڵȴִе signal, ȵѾύͼִ
+	const uint64_t submitted = frameCount_;
+	const VkSemaphoreWaitInfoKHR waitInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+		.semaphoreCount = 1,
+		.pSemaphores = &graphicsTimeline_,
+		.pValues = &submitted,
+	};
+	timelineSemaphore_->waitSemaphores(device_, &waitInfo, std::numeric_limits<uint64_t>::max());
+	const VkSemaphoreSignalInfoKHR signalInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR,
+		.semaphore = graphicsTimeline_,
+		.value = graphicsWaitValue_,
+	};
+	timelineSemaphore_->signalSemaphore(device_, &signalInfo);
+}
+
+void VulkanApplication::destroyAsyncCompute() noexcept
+{
+	if (!asyncCompute_.has_value()) return;
+	if constexpr (enableDebugOutput) {
+		std::println("async compute: {} submits", asyncCompute_->submitCount());
+	}
+	asyncCompute_.reset();
+	computeWaits_.clear();
+}
+
+void VulkanApplication::destroyUploadEngine() noexcept
+{
+	if (!uploadEngine_.has_value()) return;
+	if constexpr (enableDebugOutput) {
+		const auto stats = uploadEngine_->stats();
+		std::println("upload engine: {} requests, {} bytes in {} batches, {} staging stalls",
+			stats.requestCount, stats.uploadedBytes, stats.batchCount, stats.stagingStalls);
+	}
+	uploadEngine_.reset();
 }
 
-void VulkanApplication::createSwapChain()
+void VulkanApplication::createSwapChain(VkSwapchainKHR oldSwapChain)
 {
-	uint32_t imageCount = surfaceCapabilities_.minImageCount + 1;
+	uint32_t imageCount = settings_.swapChainImageCount;
+	if (imageCount == 0) {
+		imageCount = surfaceCapabilities_.minImageCount + 1;
+		// MAILBOX ֻпͼȾʱŲ
+		if (surfacePresentMode_ == VK_PRESENT_MODE_MAILBOX_KHR) {
+			imageCount = std::max(imageCount, 3u);
+		}
+	}
+	imageCount = std::max(imageCount, surfaceCapabilities_.minImageCount);
 	// maxImageCount == 0ζûֵ
 	if(surfaceCapabilities_.maxImageCount != 0) {
 		imageCount = std::min(imageCount, surfaceCapabilities_.maxImageCount);
 	}
 
-	VkExtent2D extent{};
-	if (surfaceCapabilities_.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
-		extent = surfaceCapabilities_.currentExtent;
-	}else {
-		int width, height;
-		glfwGetFramebufferSize(pWindow_, &width, &height);
-		extent = {
-			static_cast<uint32_t>(width),
-			static_cast<uint32_t>(height)
-		};
-		extent.width = std::clamp(extent.width, surfaceCapabilities_.minImageExtent.width, surfaceCapabilities_.maxImageExtent.width);
-		extent.height = std::clamp(extent.height, surfaceCapabilities_.minImageExtent.height, surfaceCapabilities_.maxImageExtent.height);
-	}
+	const VkExtent2D extent = chooseSwapChainExtent();
 
 	VkSwapchainCreateInfoKHR createInfo{
 		.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -499,6 +7028,7 @@ void VulkanApplication::createSwapChain()
 		/*
 		 * VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT: ͼֱȾ
 		 * VK_IMAGE_USAGE_TRANSFER_DST_BIT : ȾͼϣԱкȻ䵽ͼ
+		 * Ŀǰ render graph ֱӰѽͼΪ attachment Ⱦ (COLOR_ATTACHMENT ֵ֧)
 		 */
 		.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
 		.preTransform = surfaceCapabilities_.currentTransform,
@@ -508,7 +7038,7 @@ void VulkanApplication::createSwapChain()
 		.presentMode = surfacePresentMode_,
 		// ıڵصɫ
 		.clipped = VK_TRUE,
-		.oldSwapchain = VK_NULL_HANDLE,
+		.oldSwapchain = oldSwapChain,
 	};
 
 	/*
@@ -533,33 +7063,466 @@ void VulkanApplication::createSwapChain()
 	if constexpr (enableDebugOutput) {
 		std::println("the info of created swap chain:");
 		std::println("image count:{}", imageCount);
+		std::println("present mode:{}", presentModeName(surfacePresentMode_));
 		std::println("extent:({},{})", extent.width, extent.height);
 	}
 
-	swapChainImages_ = getVkResource(vkGetSwapchainImagesKHR, device_, swapChain_);
+	//  swapChainImages_ е, ´ʱҪ·
+	StartupProfiler::instance().measure("vkGetSwapchainImagesKHR", [&] {
+		getVkResourceInto(swapChainImages_, vkGetSwapchainImagesKHR, device_, swapChain_);
+	});
+
+	swapChainImageViews_.assign(swapChainImages_.size(), VK_NULL_HANDLE);
+	for (const auto [image, view] : std::views::zip(swapChainImages_, swapChainImageViews_)) {
+		const VkImageViewCreateInfo viewCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = surfaceFormat_.format,
+			.components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY },
+			.subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1 },
+		};
+		if (vkCreateImageView(device_, &viewCreateInfo, nullptr, &view) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create swap chain image view");
+		}
+	}
+
+	const VkSemaphoreCreateInfo semaphoreCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+	};
+	renderFinishedSemaphores_.assign(swapChainImages_.size(), VK_NULL_HANDLE);
+	for (auto& semaphore : renderFinishedSemaphores_) {
+		if (vkCreateSemaphore(device_, &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create frame synchronization objects");
+		}
+	}
+
+	buildRenderGraph(extent);
+	configureFramePacing();
+}
+
+void VulkanApplication::buildRenderGraph(VkExtent2D extent)
+{
+	renderGraph_ = std::make_unique<RenderGraph>(device_, *allocator_, dynamicRendering_);
+	// ͼÿ֡д, ֮ǰݲҪ, ԳʼΪ UNDEFINED
+	backBuffer_ = renderGraph_->importImage("back buffer", RenderGraph::ImageDesc{ .format = surfaceFormat_.format, .extent = extent },
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	// ûй, ʱֻͼΪ֡仯ɫ
+	// ɫÿ֡ͬ, ܷ loadOp  clearValue , Ⱦ vkCmdClearAttachments
+	renderGraph_->addPass("clear",
+		[this](RenderGraph::PassBuilder& builder) {
+			builder.colorAttachment(backBuffer_, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+			builder.secondaryCommandBuffers();
+		},
+		[this](VkCommandBuffer commandBuffer, const RenderGraph::PassContext& context) {
+			const float t = static_cast<float>(frameCount_ % 240) / 240.0f;
+			const VkClearAttachment attachment{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.colorAttachment = 0,
+				.clearValue = { .color = { .float32 = { t, 0.2f, 1.0f - t, 1.0f } } },
+			};
+			const VkClearRect rect{
+				.rect = { .offset = { 0, 0 }, .extent = context.renderArea() },
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			};
+			const std::array<CommandRecorder::RecordFunction, 1> tasks{
+				[&](VkCommandBuffer secondary) {
+					vkCmdClearAttachments(secondary, 1, &attachment, 1, &rect);
+				},
+			};
+			commandRecorder_->record(commandBuffer, context.inheritance(), tasks);
+		});
+
+	renderGraph_->compile();
+	if constexpr (enableDebugOutput) {
+		const auto& stats = renderGraph_->stats();
+		std::println("render graph ({}): {} passes ({} culled), {} barriers in {} batches, {} transient images in {} memory slots ({} / {} bytes)",
+			renderGraph_->dynamicRendering() ? "dynamic rendering" : "render pass", stats.passCount, stats.culledPassCount, stats.imageBarrierCount, stats.barrierBatchCount,
+			stats.transientImageCount, stats.memorySlotCount, stats.allocatedBytes, stats.transientBytes);
+	}
+}
+
+void VulkanApplication::configureFramePacing()
+{
+	getPastPresentationTiming_ = nullptr;
+	if (displayTimingSupported_) {
+		const auto getRefreshCycleDuration = reinterpret_cast<PFN_vkGetRefreshCycleDurationGOOGLE>(
+			vkGetDeviceProcAddr(device_, "vkGetRefreshCycleDurationGOOGLE"));
+		VkRefreshCycleDurationGOOGLE refreshCycle{};
+		// ֧չ surface ܱʾʱ ( headless surface), òˢʱ˻Ϊ CPU ʱ
+		if (getRefreshCycleDuration != nullptr && getRefreshCycleDuration(device_, swapChain_, &refreshCycle) == VK_SUCCESS) {
+			getPastPresentationTiming_ = reinterpret_cast<PFN_vkGetPastPresentationTimingGOOGLE>(
+				vkGetDeviceProcAddr(device_, "vkGetPastPresentationTimingGOOGLE"));
+			framePacer_.configure(getPastPresentationTiming_ != nullptr, std::chrono::nanoseconds(refreshCycle.refreshDuration));
+			if (getPastPresentationTiming_ != nullptr) return;
+		}
+	}
+
+	// CPU ʱֻ present  vblank ʱܷӳˢ
+	std::chrono::nanoseconds refreshPeriod{ 0 };
+	const bool vsync = surfacePresentMode_ == VK_PRESENT_MODE_FIFO_KHR || surfacePresentMode_ == VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	if (!settings_.headless && vsync) {
+		if (const auto pMonitor = glfwGetPrimaryMonitor(); pMonitor != nullptr) {
+			if (const auto pMode = glfwGetVideoMode(pMonitor); pMode != nullptr && pMode->refreshRate > 0) {
+				refreshPeriod = std::chrono::nanoseconds(1'000'000'000 / pMode->refreshRate);
+			}
+		}
+	}
+	framePacer_.configure(false, refreshPeriod);
+}
+
+void VulkanApplication::collectPresentationTimings()
+{
+	// ʹ getVkResourceInto: ʱĴ, һ֡ؽ¿ʼ
+	uint32_t count = 0;
+	if (getPastPresentationTiming_(device_, swapChain_, &count, nullptr) != VK_SUCCESS || count == 0) return;
+	pastPresentationTimings_.resize(count);
+	const auto result = getPastPresentationTiming_(device_, swapChain_, &count, pastPresentationTimings_.data());
+	if (result != VK_SUCCESS && result != VK_INCOMPLETE) return;
+	// VK_INCOMPLETE ʱʣµļ¼һ֡
+	for (const auto& timing : std::span(pastPresentationTimings_.data(), count)) {
+		framePacer_.displayed(timing.presentID, timing.actualPresentTime);
+	}
 }
 
 void VulkanApplication::destroySwapChain() noexcept
 {
+	destroyRetiredSwapChains(true);
+	renderGraph_.reset();
+	//  vkDestroy* ܿվ
+	for (const auto view : swapChainImageViews_) {
+		vkDestroyImageView(device_, view, nullptr);
+	}
+	swapChainImageViews_.clear();
+	for (const auto semaphore : renderFinishedSemaphores_) {
+		vkDestroySemaphore(device_, semaphore, nullptr);
+	}
+	renderFinishedSemaphores_.clear();
 	vkDestroySwapchainKHR(device_, swapChain_, nullptr);
 }
 
-std::vector<const char*> VulkanApplication::getRequiredDeviceExtensions(VkPhysicalDevice device)
+VkExtent2D VulkanApplication::chooseSwapChainExtent() const
 {
-	std::vector<const char*> requiredExtensions{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	VkExtent2D extent{};
+	if (surfaceCapabilities_.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
+		extent = surfaceCapabilities_.currentExtent;
+	}else if (settings_.headless) {
+		// headless surface  currentExtent δ, ӦԼС
+		extent = windowExtent_;
+		extent.width = std::clamp(extent.width, surfaceCapabilities_.minImageExtent.width, surfaceCapabilities_.maxImageExtent.width);
+		extent.height = std::clamp(extent.height, surfaceCapabilities_.minImageExtent.height, surfaceCapabilities_.maxImageExtent.height);
+	}else {
+		int width, height;
+		glfwGetFramebufferSize(pWindow_, &width, &height);
+		extent = {
+			static_cast<uint32_t>(width),
+			static_cast<uint32_t>(height)
+		};
+		extent.width = std::clamp(extent.width, surfaceCapabilities_.minImageExtent.width, surfaceCapabilities_.maxImageExtent.width);
+		extent.height = std::clamp(extent.height, surfaceCapabilities_.minImageExtent.height, surfaceCapabilities_.maxImageExtent.height);
+	}
+	return extent;
+}
+
+bool VulkanApplication::recreateSwapChain()
+{
+	// currentExtent 洰ڴС仯, ؽǰ²ѯ
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice_, surface_, &surfaceCapabilities_);
+	if (const auto extent = chooseSwapChainExtent(); extent.width == 0 || extent.height == 0) {
+		return false;
+	}
 
+	//  oldSwapchain ɽ retire (ʹʧ), ֮ٴ acquire
+	retiredSwapChains_.push_back(RetiredSwapChain{
+		.swapChain = std::exchange(swapChain_, VK_NULL_HANDLE),
+		.imageViews = std::exchange(swapChainImageViews_, {}),
+		.renderFinishedSemaphores = std::exchange(renderFinishedSemaphores_, {}),
+		.renderGraph = std::move(renderGraph_),
+		.retiredAtFrame = frameCount_,
+	});
+	createSwapChain(retiredSwapChains_.back().swapChain);
+	swapChainOutdated_ = false;
+	framePacer_.discontinuity();
+	return true;
+}
+
+void VulkanApplication::destroyRetiredSwapChains(bool all) noexcept
+{
 	/*
-	 * ʹvkEnumerateInstanceϵкҪ extension Ƿ֧
+	 * drawFrame ÿ֡ȴǰ֡λ fence,  framesInFlight ֮֡ǰύһ֡
+	 * ؽ֮ٹ framesInFlight ֡, ÿλȴһ, ؽǰύ֡ȫִ
+	 * present û fence (Ҫ VK_EXT_swapchain_maintenance1), ٶһ֡ present ȡͼ
 	 */
-	std::vector<VkExtensionProperties> availableExtensions = getVkResource(vkEnumerateDeviceExtensionProperties, device, nullptr);
+	std::erase_if(retiredSwapChains_, [this, all](const RetiredSwapChain& retired) {
+		if (!all && frameCount_ < retired.retiredAtFrame + frames_.size()) return false;
+		for (const auto semaphore : retired.renderFinishedSemaphores) {
+			vkDestroySemaphore(device_, semaphore, nullptr);
+		}
+		for (const auto view : retired.imageViews) {
+			vkDestroyImageView(device_, view, nullptr);
+		}
+		vkDestroySwapchainKHR(device_, retired.swapChain, nullptr);
+		return true;
+	});
+}
 
-	if constexpr (enableDebugOutput) {
-		std::println("the available {} device extensions are:", availableExtensions.size());
-		for (const auto& [extensionName, specVersion] : availableExtensions) {
-			std::println("{} (version {})", extensionName, specVersion);
+bool VulkanApplication::minimized() const
+{
+	if (settings_.headless) return false;
+	int width, height;
+	glfwGetFramebufferSize(pWindow_, &width, &height);
+	return width == 0 || height == 0;
+}
+
+void VulkanApplication::createFrameResources()
+{
+	if (settings_.framesInFlight == 0) {
+		throw std::runtime_error("framesInFlight must be at least 1");
+	}
+	currentFrame_ = 0;
+	frameCount_ = 0;
+
+	const VkSemaphoreCreateInfo semaphoreCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+	};
+	// ʼΪ signaled, һεȴʱ
+	const VkFenceCreateInfo fenceCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		.flags = VK_FENCE_CREATE_SIGNALED_BIT,
+	};
+	// command buffer ÿ֡¼, Ϊ transient
+	const VkCommandPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = queueFamilyIndices_.graphicsFamily,
+	};
+
+	// ȷ frames_ ٴ, ;ʧʱ destroyFrameResources ֻҪվ
+	frames_.assign(settings_.framesInFlight, FrameResources{});
+	for (auto& frame : frames_) {
+		if (vkCreateCommandPool(device_, &poolCreateInfo, nullptr, &frame.commandPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create command pool");
+		}
+		const VkCommandBufferAllocateInfo allocateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = frame.commandPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+		if (vkAllocateCommandBuffers(device_, &allocateInfo, &frame.commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate command buffer");
+		}
+		if (vkCreateFence(device_, &fenceCreateInfo, nullptr, &frame.inFlightFence) != VK_SUCCESS ||
+			vkCreateSemaphore(device_, &semaphoreCreateInfo, nullptr, &frame.imageAvailableSemaphore) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create frame synchronization objects");
 		}
 	}
 
+	commandRecorder_.emplace(device_, *jobSystem_, queueFamilyIndices_.graphicsFamily, settings_.framesInFlight);
+
+	graphicsTimeline_ = VK_NULL_HANDLE;
+	if (timelineSemaphore_.has_value()) {
+		const VkSemaphoreTypeCreateInfoKHR typeCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+			.initialValue = 0,
+		};
+		const VkSemaphoreCreateInfo timelineCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &typeCreateInfo,
+		};
+		if (vkCreateSemaphore(device_, &timelineCreateInfo, nullptr, &graphicsTimeline_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create graphics timeline semaphore");
+		}
+	}
+}
+
+void VulkanApplication::destroyFrameResources() noexcept
+{
+	commandRecorder_.reset();
+	//  vkDestroy* ܿվ
+	vkDestroySemaphore(device_, graphicsTimeline_, nullptr);
+	graphicsTimeline_ = VK_NULL_HANDLE;
+	for (const auto& frame : frames_) {
+		vkDestroySemaphore(device_, frame.imageAvailableSemaphore, nullptr);
+		vkDestroyFence(device_, frame.inFlightFence, nullptr);
+		// command buffer  pool һͷ
+		vkDestroyCommandPool(device_, frame.commandPool, nullptr);
+	}
+	frames_.clear();
+}
+
+uint64_t VulkanApplication::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+	const VkCommandBufferBeginInfo beginInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording command buffer");
+	}
+	gpuProfiler_->beginFrame(currentFrame_, commandBuffer, frameCount_);
+	//  pass ֮ǰ acquire Ѿɵϴ, ֮ pass ʹ ready Դ
+	const uint64_t uploadWaitValue = uploadEngine_.has_value() ? uploadEngine_->acquire(commandBuffer) : 0;
+	// scope ʱдʱ,  vkEndCommandBuffer ֮ǰ
+	{
+		const auto framePass = gpuProfiler_->pass(commandBuffer, "frame");
+		// barrier Ͳת (UNDEFINED ->  pass ҪĲ -> PRESENT_SRC_KHR)  render graph 
+		renderGraph_->setImportedImage(backBuffer_, swapChainImages_[imageIndex], swapChainImageViews_[imageIndex]);
+		renderGraph_->execute(commandBuffer, *gpuProfiler_);
+	}
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record command buffer");
+	}
+	return uploadWaitValue;
+}
+
+void VulkanApplication::drawFrame()
+{
+	/*
+	 * 1. ȴ֡һεύִ (ֻ framesInFlight ֮֡ǰһ֡)
+	 * 2. acquire ͼ
+	 * 3. ò¼Ƹ֡ command buffer
+	 * 4. ύ: ȴ imageAvailable (Լɵϴ compute), signal renderFinished, graphicsTimeline_  fence
+	 * 5. present: ȴ renderFinished
+	 * acquire  present 潻ʱֻ, һ֡ʼʱؽ
+	 */
+	if (pendingError_ != nullptr) {
+		std::rethrow_exception(std::exchange(pendingError_, nullptr));
+	}
+	jobSystem_->runMainThreadJobs();
+	if (swapChainOutdated_ && !recreateSwapChain()) {
+		// С, ûпȾͼ
+		framePacer_.discontinuity();
+		return;
+	}
+
+	auto& frame = frames_[currentFrame_];
+	vkWaitForFences(device_, 1, &frame.inFlightFence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	destroyRetiredSwapChains(false);
+	// ֡һε GPU ʱѾд, زȴ
+	gpuProfiler_->collect(currentFrame_);
+	if (asyncCompute_.has_value()) {
+		asyncCompute_->beginFrame(currentFrame_);
+	}
+
+	uint32_t imageIndex;
+	framePacer_.beginAcquire();
+	const VkResult acquireResult = vkAcquireNextImageKHR(device_, swapChain_, std::numeric_limits<uint64_t>::max(),
+		frame.imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+	framePacer_.endAcquire();
+	if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
+		// û acquire ͼ, semaphore Ҳᱻ signal, ֱӷһ֡
+		swapChainOutdated_ = true;
+		framePacer_.discontinuity();
+		return;
+	}
+	if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR) {
+		throw std::runtime_error("failed to acquire swap chain image");
+	}
+
+	// ȷύ֮ reset,  acquire ʧʱһεȴԶ
+	vkResetFences(device_, 1, &frame.inFlightFence);
+	vkResetCommandPool(device_, frame.commandPool, 0);
+	commandRecorder_->beginFrame(currentFrame_);
+	if (bindlessHeap_.has_value()) {
+		bindlessHeap_->beginFrame(frameCount_);
+	}
+	const uint64_t uploadWaitValue = recordCommandBuffer(frame.commandBuffer, imageIndex);
+	if (uploadEngine_.has_value()) {
+		uploadEngine_->submit();
+	}
+
+	// ͼڵһαʹõ stage ֮ǰȴ acquire, render graph ĵһ barrier ֮ν
+	// ϴ semaphore  acquire ʱѾ signal, ȴֻΪ˽е, 
+	// binary semaphore ֵ
+	SmallVector<VkSemaphore, 8> waitSemaphores;
+	SmallVector<VkPipelineStageFlags, 8> waitStages;
+	SmallVector<uint64_t, 8> waitValues;
+	waitSemaphores.push_back(frame.imageAvailableSemaphore);
+	waitStages.push_back(renderGraph_->firstStage(backBuffer_));
+	waitValues.push_back(0);
+	if (uploadWaitValue != 0) {
+		waitSemaphores.push_back(uploadEngine_->semaphore());
+		waitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		waitValues.push_back(uploadWaitValue);
+	}
+	for (const auto& wait : computeWaits_) {
+		waitSemaphores.push_back(wait.semaphore);
+		waitStages.push_back(wait.stage);
+		waitValues.push_back(wait.value);
+	}
+	computeWaits_.clear();
+	const std::array<VkSemaphore, 2> signalSemaphores{ renderFinishedSemaphores_[imageIndex], graphicsTimeline_ };
+	const std::array<uint64_t, 2> signalValues{ 0, frameCount_ + 1 };
+	const bool timeline = graphicsTimeline_ != VK_NULL_HANDLE;
+	const VkTimelineSemaphoreSubmitInfoKHR timelineInfo{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+		.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+		.pWaitSemaphoreValues = waitValues.data(),
+		.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+		.pSignalSemaphoreValues = signalValues.data(),
+	};
+	const VkSubmitInfo submitInfo{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = timeline ? &timelineInfo : nullptr,
+		.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+		.pWaitSemaphores = waitSemaphores.data(),
+		.pWaitDstStageMask = waitStages.data(),
+		.commandBufferCount = 1,
+		.pCommandBuffers = &frame.commandBuffer,
+		.signalSemaphoreCount = timeline ? 2u : 1u,
+		.pSignalSemaphores = signalSemaphores.data(),
+	};
+	if (queueTopology_->queue(QueueTopology::Role::Render).submit({ &submitInfo, 1 }, frame.inFlightFence) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit draw command buffer");
+	}
+	framePacer_.submitted();
+
+	// desiredPresentTime Ϊ 0: ֻȡʾʱ, Ҫضʱʾ
+	const auto presentId = static_cast<uint32_t>(frameCount_);
+	const VkPresentTimeGOOGLE presentTime{
+		.presentID = presentId,
+		.desiredPresentTime = 0,
+	};
+	const VkPresentTimesInfoGOOGLE presentTimesInfo{
+		.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE,
+		.swapchainCount = 1,
+		.pTimes = &presentTime,
+	};
+	const VkPresentInfoKHR presentInfo{
+		.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+		.pNext = getPastPresentationTiming_ != nullptr ? &presentTimesInfo : nullptr,
+		.waitSemaphoreCount = 1,
+		.pWaitSemaphores = &renderFinishedSemaphores_[imageIndex],
+		.swapchainCount = 1,
+		.pSwapchains = &swapChain_,
+		.pImageIndices = &imageIndex,
+	};
+	const VkResult presentResult = queueTopology_->queue(QueueTopology::Role::Present).present(presentInfo);
+	if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || acquireResult == VK_SUBOPTIMAL_KHR) {
+		swapChainOutdated_ = true;
+	}
+	else if (presentResult != VK_SUCCESS) {
+		throw std::runtime_error("failed to present swap chain image");
+	}
+	framePacer_.presented(presentId);
+	if (getPastPresentationTiming_ != nullptr) {
+		collectPresentationTimings();
+	}
+
+	currentFrame_ = (currentFrame_ + 1) % static_cast<uint32_t>(frames_.size());
+	frameCount_++;
+}
+
+std::expected<std::vector<const char*>, std::string> VulkanApplication::getRequiredDeviceExtensions(
+	const std::vector<VkExtensionProperties>& availableExtensions)
+{
+	std::vector<const char*> requiredExtensions{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+
 	std::vector<std::string_view> unsupportedExtensions;
 	for (const auto required : requiredExtensions) {
 		if (
@@ -577,79 +7540,126 @@ std::vector<const char*> VulkanApplication::getRequiredDeviceExtensions(VkPhysic
 			unsupportedExtensions |
 			std::views::join_with(',') |
 			std::ranges::to<std::string>();
-		throw std::runtime_error(std::format("device extension requested {}, but not available", str));
+		return std::unexpected(std::format("device extension requested {}, but not available", str));
 	}
 
 	return requiredExtensions;
 }
 
-VulkanApplication::QueueFamilyIndices VulkanApplication::getQueueFamilyIndices(VkPhysicalDevice device, VkSurfaceKHR surface)
+std::expected<VulkanApplication::QueueFamilyIndices, std::string> VulkanApplication::getQueueFamilyIndices(const DeviceCapabilities& capabilities)
 {
-	std::vector<VkQueueFamilyProperties> queueFamilies = getVkResource(vkGetPhysicalDeviceQueueFamilyProperties, device);
-
 	QueueFamilyIndices queueFamilyIndices{};
-	bool graphic = false;
-	bool present = false;
+	const auto& queueFamilies = capabilities.queueFamilies;
 
 	auto pGraphicsFamily = std::ranges::find_if(queueFamilies, [](const auto& family) {
 		return family.queueFlags & VK_QUEUE_GRAPHICS_BIT;
 	});
-	if (pGraphicsFamily == queueFamilies.end()) throw std::runtime_error("can not found queue family which satisfied VK_QUEUE_GRAPHICS_BIT");
+	if (pGraphicsFamily == queueFamilies.end()) return std::unexpected("can not found queue family which satisfied VK_QUEUE_GRAPHICS_BIT");
 	queueFamilyIndices.graphicsFamily = pGraphicsFamily - queueFamilies.begin();
 
-	auto enumQueueFamilies = queueFamilies | std::views::enumerate;
-	auto pPresentFamily = std::ranges::find_if(enumQueueFamilies, [device, surface](const auto& pair) {
-		const auto& [index, family] = pair;
-		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, index, surface, &presentSupport);
-		return presentSupport == VK_TRUE;
-	});
-	if (pPresentFamily == enumQueueFamilies.end()) throw std::runtime_error("can not found queue family which satisfied SurfaceSupport");
-	queueFamilyIndices.presentFamily = pPresentFamily - enumQueueFamilies.begin();
+	auto pPresentFamily = std::ranges::find(capabilities.presentSupport, VK_TRUE);
+	if (pPresentFamily == capabilities.presentSupport.end()) return std::unexpected("can not found queue family which satisfied SurfaceSupport");
+	queueFamilyIndices.presentFamily = pPresentFamily - capabilities.presentSupport.begin();
 
-	if constexpr (enableDebugOutput) {
-		std::println("choose queue family {} for graphics, {} for present",
-			queueFamilyIndices.graphicsFamily, queueFamilyIndices.presentFamily);
+	// graphics  compute ֧ transfer, ѡ֧ graphics  compute 
+	auto pTransferFamily = std::ranges::find_if(queueFamilies, [](const auto& family) {
+		return (family.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+	});
+	if (pTransferFamily == queueFamilies.end()) {
+		pTransferFamily = std::ranges::find_if(queueFamilies, [](const auto& family) {
+			return (family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+		});
 	}
+	queueFamilyIndices.transferFamily = pTransferFamily != queueFamilies.end() ?
+		static_cast<uint32_t>(pTransferFamily - queueFamilies.begin()) : queueFamilyIndices.graphicsFamily;
+
+	// ֧ graphics  compute ͨӦ첽
+	auto pComputeFamily = std::ranges::find_if(queueFamilies, [](const auto& family) {
+		return (family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+	});
+	queueFamilyIndices.computeFamily = pComputeFamily != queueFamilies.end() ?
+		static_cast<uint32_t>(pComputeFamily - queueFamilies.begin()) : queueFamilyIndices.graphicsFamily;
+
 	return queueFamilyIndices;
 }
 
-std::tuple<VkSurfaceCapabilitiesKHR, VkSurfaceFormatKHR, VkPresentModeKHR> VulkanApplication::getSwapChainSupport(
-	VkPhysicalDevice device, VkSurfaceKHR surface)
+std::expected<std::tuple<VkSurfaceCapabilitiesKHR, VkSurfaceFormatKHR, VkPresentModeKHR>, std::string> VulkanApplication::getSwapChainSupport(
+	VkPhysicalDevice device, VkSurfaceKHR surface, const DeviceCapabilities& deviceCapabilities, PresentPolicy policy)
 {
+	// surface capability е currentExtent 洰ڴС仯, ܷŽ, ²ѯ
 	VkSurfaceCapabilitiesKHR capabilities;
 	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &capabilities);
 
-	std::vector<VkSurfaceFormatKHR> formats = getVkResource(vkGetPhysicalDeviceSurfaceFormatsKHR, device, surface);
+	const auto& formats = deviceCapabilities.surfaceFormats;
 	auto pFormat = std::ranges::find_if(formats, [](auto format) {
 		return format.format == VK_FORMAT_B8G8R8A8_SRGB && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
 	});
-	if (pFormat == formats.end()) throw std::runtime_error("no suitable format");
+	if (pFormat == formats.end()) return std::unexpected("no suitable format");
 
-	std::vector<VkPresentModeKHR> presentModes = getVkResource(vkGetPhysicalDeviceSurfacePresentModesKHR, device, surface);
+	const auto& presentModes = deviceCapabilities.presentModes;
 	/*
 	 * VK_PRESENT_MODE_IMMEDIATE_KHR: ͼύֱȾĻ
 	 * VK_PRESENT_MODE_FIFO_KHR: һУˢʵٶͼʾĻϣͼύӣʱȴҲֻ "vertical blank" ʱύͼ
 	 * VK_PRESENT_MODE_FIFO_RELAXED_KHR: ͼύʱΪգֱȾĻϣͬ
 	 * VK_PRESENT_MODE_MAILBOX_KHR: ʱֱӽͼ滻Ϊύͼ
 	 */
-	auto pPresentMode = std::ranges::find(presentModes, VK_PRESENT_MODE_FIFO_KHR);
-	if(pPresentMode == presentModes.end()) throw std::runtime_error("no suitable present mode");
+	std::span<const VkPresentModeKHR> candidates;
+	switch (policy) {
+	case PresentPolicy::LowLatency: {
+		static constexpr std::array modes{ VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+		candidates = modes;
+		break;
+	}
+	case PresentPolicy::Uncapped: {
+		static constexpr std::array modes{ VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+		candidates = modes;
+		break;
+	}
+	case PresentPolicy::Relaxed: {
+		static constexpr std::array modes{ VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+		candidates = modes;
+		break;
+	}
+	case PresentPolicy::PowerSaving: {
+		static constexpr std::array modes{ VK_PRESENT_MODE_FIFO_KHR };
+		candidates = modes;
+		break;
+	}
+	}
+	auto pPresentMode = std::ranges::find_first_of(candidates, presentModes);
+	if(pPresentMode == candidates.end()) return std::unexpected("no suitable present mode");
 
-	return { capabilities, *pFormat, *pPresentMode };
+	return std::tuple{ capabilities, *pFormat, *pPresentMode };
 }
 
 void VulkanApplication::createSurface()
 {
+	if (settings_.headless) {
+		VkHeadlessSurfaceCreateInfoEXT createInfo{
+			.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT,
+		};
+		if (createHeadlessSurfaceEXT(instance_, &createInfo, nullptr, &surface_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create headless surface!");
+		}
+		return;
+	}
+
+#ifdef VK_USE_PLATFORM_WIN32_KHR
 	VkWin32SurfaceCreateInfoKHR createInfo{
 		.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
 		.hinstance = GetModuleHandle(nullptr),
 		.hwnd = glfwGetWin32Window(pWindow_),
 	};
-	
+
 	if(vkCreateWin32SurfaceKHR(instance_, &createInfo, nullptr, &surface_) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create surface!");
 	}
+#else
+	//  windows ƽ̨ glfw ѡӦĴϵͳ
+	if (glfwCreateWindowSurface(instance_, pWindow_, nullptr, &surface_) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create surface!");
+	}
+#endif
 }
 
 void VulkanApplication::destroySurface() noexcept
@@ -657,39 +7667,104 @@ void VulkanApplication::destroySurface() noexcept
 	vkDestroySurfaceKHR(instance_, surface_, nullptr);
 }
 
-VulkanApplication::VulkanApplication(const uint32_t width, const uint32_t height, const std::string_view appName)
+VulkanApplication::VulkanApplication(const uint32_t width, const uint32_t height, const std::string_view appName, const ApplicationSettings& settings)
+	: settings_(settings)
 {
 	pWindow_ = nullptr;
 	instance_ = VK_NULL_HANDLE;
 	surface_ = VK_NULL_HANDLE;
 	device_ = VK_NULL_HANDLE;
 	swapChain_ = VK_NULL_HANDLE;
-	createWindow(width, height, appName);
-	createInstance(appName);
-	createSurface();
-	pickPhysicalDevice();
-	createLogicalDevice();
-	createSwapChain();
+	pipelineCache_ = VK_NULL_HANDLE;
+	capabilitySnapshotDirty_ = false;
+	swapChainOutdated_ = false;
+	displayTimingSupported_ = false;
+	getPastPresentationTiming_ = nullptr;
+	physicalDeviceProperties2Supported_ = false;
+	instanceApiVersion_ = VK_API_VERSION_1_0;
+	getPhysicalDeviceFeatures2_ = nullptr;
+	getPhysicalDeviceProperties2_ = nullptr;
+	descriptorIndexingSupported_ = false;
+	dynamicRenderingSupported_ = false;
+	timelineSemaphoreSupported_ = false;
+	graphicsTimeline_ = VK_NULL_HANDLE;
+	graphicsWaitValue_ = 0;
+	computeSharesRenderQueue_ = false;
+
+	auto& profiler = StartupProfiler::instance();
+	profiler.measure("VulkanApplication", [&] {
+		profiler.measure("createVulkanLoader", [&] { createVulkanLoader(); });
+		profiler.measure("createWindow", [&] { createWindow(width, height, appName); });
+		profiler.measure("createJobSystem", [&] { createJobSystem(); });
+		if (settings_.useCapabilitySnapshot) {
+			profiler.measure("loadCapabilitySnapshot", [&] { loadCapabilitySnapshot(); });
+		}
+		profiler.measure("createInstance", [&] { createInstance(appName); });
+		profiler.measure("createSurface", [&] { createSurface(); });
+		profiler.measure("pickPhysicalDevice", [&] { pickPhysicalDevice(); });
+		profiler.measure("createLogicalDevice", [&] { createLogicalDevice(); });
+		profiler.measure("createAllocator", [&] { createAllocator(); });
+		profiler.measure("createGpuProfiler", [&] { createGpuProfiler(); });
+		profiler.measure("createBindlessHeap", [&] { createBindlessHeap(); });
+		profiler.measure("createUploadEngine", [&] { createUploadEngine(); });
+		profiler.measure("createAsyncCompute", [&] { createAsyncCompute(); });
+		profiler.measure("createPipelineCache", [&] { createPipelineCache(); });
+		profiler.measure("createSwapChain", [&] { createSwapChain(VK_NULL_HANDLE); });
+		profiler.measure("createFrameResources", [&] { createFrameResources(); });
+	});
+	profiler.finish();
+
+	// дշڼʱ֮, ֻӰ´
+	if (settings_.useCapabilitySnapshot && capabilitySnapshotDirty_) {
+		saveCapabilitySnapshot();
+	}
+
+	if (enableDebugOutput || !settings_.startupTracePath.empty()) {
+		profiler.printSummary();
+	}
+	if (!settings_.startupTracePath.empty()) {
+		profiler.writeChromeTrace(settings_.startupTracePath);
+	}
 }
 
 VulkanApplication::~VulkanApplication()
 {
+	// ȴ in flight ִ֡ϺʹõԴ
+	releaseGraphicsWaits();
+	vkDeviceWaitIdle(device_);
+	destroyGpuProfiler();
+	destroyFrameResources();
+	destroyBindlessHeap();
+	destroyAsyncCompute();
+	destroyUploadEngine();
 	destroySwapChain();
+	destroyPipelineCache();
+	destroyAllocator();
 	destroyLogicalDevice();
 	destroySurface();
 	destroyInstance();
+	destroyJobSystem();
 	destroyWindow();
+	destroyVulkanLoader();
+}
+
+void VulkanApplication::createVulkanLoader()
+{
+	vulkanLoader_.emplace();
+}
+
+void VulkanApplication::destroyVulkanLoader() noexcept
+{
+	vulkanLoader_.reset();
 }
 
 
-std::vector<const char*> VulkanApplication::getRequiredLayers() {
+std::vector<const char*> VulkanApplication::getRequiredLayers(const std::vector<VkLayerProperties>& availableLayers) {
 	std::vector<const char*> requiredLayers;
 	if constexpr (enableValiLayer) {
 		requiredLayers.push_back("VK_LAYER_KHRONOS_validation");
 	}
 
-	std::vector<VkLayerProperties> availableLayers = getVkResource(vkEnumerateInstanceLayerProperties);
-
 	if constexpr (enableDebugOutput) {
 		std::println("the available {} layers are:", availableLayers.size());
 		for (const auto& [layerName, specVersion, implementationVersion, description] : availableLayers) {
@@ -735,47 +7810,30 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VulkanApplication::debugHandler(
 	 * VkDebugUtilsMessageTypeFlagsEXT : ͣ GENERAL, VALIDATION, PERFORMANCE
 	 * return: ǷҪֹ ֤Ϣ  vulkan
 	 */
-	auto serverityGetter = [](VkDebugUtilsMessageSeverityFlagBitsEXT e) {
-		switch (e) {
-		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT: return "VERBOSE";
-		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT: return "INFO";
-		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT: return "WARNING";
-		case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT: return "ERROR";
-		default: return "OTHER";
-		}
-	};
-	auto typeGetter = [](VkDebugUtilsMessageTypeFlagsEXT e) {
-		switch (e) {
-		case VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT: return "GENERAL";
-		case VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT: return "VALIDATION";
-		case VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT: return "PERFORMANCE";
-		case VK_DEBUG_UTILS_MESSAGE_TYPE_DEVICE_ADDRESS_BINDING_BIT_EXT: return "DEVICE_ADDRESS_BINDING";
-		default: return "OTHER";
-		}
-	};
-	std::println("validation layer: ({},{}) {}",
-	      serverityGetter(messageSeverity),
-	      typeGetter(messageType),
-	      pCallbackData->pMessage);
+	if (pUserData == nullptr) return VK_FALSE;
+	static_cast<DebugMessageLog*>(pUserData)->push(messageSeverity, messageType, *pCallbackData);
 
 	return VK_FALSE;
 }
 
-std::vector<const char*> VulkanApplication::getInstanceRequiredExtensions() {
-	uint32_t glfwExtensionCount;
-	const auto glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-	std::vector<const char*> requiredExtensions{ glfwExtensions, glfwExtensions + glfwExtensionCount };
+std::vector<const char*> VulkanApplication::getInstanceRequiredExtensions(bool headless, const std::vector<VkExtensionProperties>& availableExtensions) {
+	std::vector<const char*> requiredExtensions;
+	if (headless) {
+		requiredExtensions = { VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME };
+	}
+	else {
+		uint32_t glfwExtensionCount;
+		const auto glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		requiredExtensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	if constexpr (enableValiLayer) {
 		requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 	}
 	
 	/*
-	 * ʹvkEnumerateInstanceϵкҪ extension Ƿ֧
+	 * Ҫ extension Ƿ֧ (availableExtensions  vkEnumerateInstance ϵк߿)
 	 */
-	std::vector<VkExtensionProperties> availableExtensions = getVkResource(vkEnumerateInstanceExtensionProperties, nullptr);
-
 	if constexpr (enableDebugOutput) {
 		std::println("the available {} extensions are:", availableExtensions.size());
 		for (const auto& [extensionName, specVersion] : availableExtensions) {
@@ -806,12 +7864,140 @@ std::vector<const char*> VulkanApplication::getInstanceRequiredExtensions() {
 	return requiredExtensions;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 	try {
         std::string applicationName = "hello, vulkan!";
         uint32_t width = 800;
         uint32_t height = 600;
-		VulkanApplication application{width, height, applicationName };
+		ApplicationSettings settings{};
+		// ޴ģʽȾ֡
+		uint64_t headlessFrames = 1000;
+		auto parseNumber = [](std::string_view arg, std::string_view prefix) -> std::optional<uint64_t> {
+			if (!arg.starts_with(prefix)) return std::nullopt;
+			uint64_t value = 0;
+			const auto str = arg.substr(prefix.size());
+			if (std::from_chars(str.data(), str.data() + str.size(), value).ec != std::errc{}) {
+				throw std::runtime_error(std::format("invalid argument {}", arg));
+			}
+			return value;
+		};
+		for (const std::string_view arg : std::span(argv + 1, argc - 1)) {
+			if (arg == "--headless") {
+				settings.headless = true;
+			}
+			else if (auto value = parseNumber(arg, "--frames-in-flight=")) {
+				settings.framesInFlight = static_cast<uint32_t>(*value);
+			}
+			else if (auto value = parseNumber(arg, "--worker-threads=")) {
+				settings.workerThreads = static_cast<uint32_t>(*value);
+			}
+			else if (arg.starts_with("--present=")) {
+				// low-latency, uncapped, relaxed, power-saving
+				const auto policy = parsePresentPolicy(arg.substr(std::string_view("--present=").size()));
+				if (!policy.has_value()) {
+					throw std::runtime_error(std::format("invalid argument {}", arg));
+				}
+				settings.presentPolicy = *policy;
+			}
+			else if (auto value = parseNumber(arg, "--swapchain-images=")) {
+				settings.swapChainImageCount = static_cast<uint32_t>(*value);
+			}
+			else if (auto value = parseNumber(arg, "--frames=")) {
+				headlessFrames = *value;
+			}
+			else if (arg.starts_with("--device=")) {
+				settings.preferredDevice = arg.substr(std::string_view("--device=").size());
+			}
+			else if (arg.starts_with("--startup-trace=")) {
+				settings.startupTracePath = arg.substr(std::string_view("--startup-trace=").size());
+			}
+			else if (arg == "--gpu-profile") {
+				settings.gpuProfiling = true;
+			}
+			else if (arg.starts_with("--frame-trace=")) {
+				settings.frameTracePath = arg.substr(std::string_view("--frame-trace=").size());
+			}
+			else if (arg == "--no-capability-snapshot") {
+				settings.useCapabilitySnapshot = false;
+			}
+			else if (arg == "--no-dynamic-rendering") {
+				settings.dynamicRendering = false;
+			}
+			else if (arg == "--robust-buffer-access") {
+				settings.robustBufferAccess = true;
+			}
+			else if (auto value = parseNumber(arg, "--render-queues=")) {
+				settings.renderQueues.count = static_cast<uint32_t>(*value);
+			}
+			else if (auto value = parseNumber(arg, "--streaming-queues=")) {
+				settings.streamingQueues.count = static_cast<uint32_t>(*value);
+			}
+			else if (auto value = parseNumber(arg, "--compute-queues=")) {
+				settings.computeQueues.count = static_cast<uint32_t>(*value);
+			}
+			else if (auto value = parseNumber(arg, "--validation-summary-interval=")) {
+				settings.validationSummaryInterval = static_cast<uint32_t>(*value);
+			}
+			else if (arg.starts_with("--validation-rate-limit=")) {
+				// N  id , <id>:N ĳ id (id ʮƻ 0x ͷʮ)
+				const auto str = arg.substr(std::string_view("--validation-rate-limit=").size());
+				if (const auto colon = str.find(':'); colon != std::string_view::npos) {
+					const auto idStr = str.substr(0, colon);
+					int32_t id = 0;
+					std::errc ec;
+					if (idStr.starts_with("0x")) {
+						uint32_t bits = 0;
+						ec = std::from_chars(idStr.data() + 2, idStr.data() + idStr.size(), bits, 16).ec;
+						id = std::bit_cast<int32_t>(bits);
+					}
+					else {
+						ec = std::from_chars(idStr.data(), idStr.data() + idStr.size(), id).ec;
+					}
+					if (ec != std::errc{}) {
+						throw std::runtime_error(std::format("invalid argument {}", arg));
+					}
+					const auto limit = parseNumber(str.substr(colon + 1), "");
+					settings.validationRateLimitOverrides[id] = static_cast<uint32_t>(*limit);
+				}
+				else {
+					settings.validationRateLimit = static_cast<uint32_t>(*parseNumber(str, ""));
+				}
+			}
+		}
+		VulkanApplication application{width, height, applicationName, settings };
+
+		// ÿһһڵƽ֡
+		using Clock = std::chrono::steady_clock;
+		auto windowStart = Clock::now();
+		uint64_t windowStartFrame = 0;
+		auto reportFps = [&] {
+			const auto now = Clock::now();
+			const std::chrono::duration<double> elapsed = now - windowStart;
+			if (elapsed.count() < 1.0) return;
+			const auto frames = application.frameCount() - windowStartFrame;
+			std::println("fps: {:.1f} ({:.3f} ms/frame)", frames / elapsed.count(), elapsed.count() * 1000.0 / std::max<uint64_t>(frames, 1));
+			windowStart = now;
+			windowStartFrame = application.frameCount();
+		};
+		auto reportFramePacing = [&application] {
+			const auto stats = application.framePacingStats();
+			std::println("frame pacing ({}): {} intervals, mean {:.3f} ms, jitter {:.3f} ms, max {:.3f} ms, {} missed vblanks (refresh {:.3f} ms), acquire {:.3f} ms",
+				stats.displayTiming ? "display timing" : "cpu", stats.intervals, stats.meanIntervalMs, stats.jitterMs,
+				stats.maxIntervalMs, stats.missedVblanks, stats.refreshPeriodMs, stats.meanAcquireMs);
+		};
+
+		if (application.headless()) {
+			const auto start = Clock::now();
+			while (application.frameCount() < headlessFrames) {
+				application.drawFrame();
+				reportFps();
+			}
+			const std::chrono::duration<double> total = Clock::now() - start;
+			std::println("rendered {} frames in {:.3f} s, average {:.1f} fps",
+				application.frameCount(), total.count(), application.frameCount() / total.count());
+			reportFramePacing();
+			return 0;
+		}
 
 		glfwSetKeyCallback(application.pWindow(), [](GLFWwindow* pWindow, int key, int scancode, int action, int mods) {
 			if (action == GLFW_PRESS) {
@@ -821,9 +8007,15 @@ int main() {
 
         while (!glfwWindowShouldClose(application.pWindow())) {
             glfwPollEvents();
+			// Сʱȴ¼, ת
+			if (application.minimized()) {
+				glfwWaitEvents();
+				continue;
+			}
+            application.drawFrame();
+            reportFps();
         }
-
-        
+		reportFramePacing();
     }
     catch (const std::exception& e) {
 
@@ -1,8 +1,17 @@
 #pragma once
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
 // ̫6ˣwindowsͷļоȻֱӶ min  max ꣡
 #define NOMINMAX
+#else
+// ʱ vulkan loader
+#include <dlfcn.h>
+#endif
+//  vulkan ԭ, ָ main.cpp е VulkanLoader , Ҫ vulkan-1.lib
+#define VK_NO_PROTOTYPES
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h>
+#ifdef _WIN32
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#endif